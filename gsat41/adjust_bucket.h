@@ -1,81 +1,69 @@
+/* The strategy flags are tested through these names, so that
+   flip_template.h can replace them by constants in the specialized
+   flip loops */
+#define BUCKET_HILLCLIMB flag_hillclimb
+#define BUCKET_ONLY_UNSAT flag_only_unsat
+
 #define adjust_bucket(VARPTR) \
 { \
     /* printf("adjusting bucket for var=%d, cmd=%d, diff=%d\n", VARPTR->name, current_max_diff, VARPTR->diff); */\
-    if (! is_in(tabu, VARPTR)){ \
-	if (flag_hillclimb){ \
-	    if (VARPTR->make > 0){ \
-		if (! is_in(walk, VARPTR)){ \
-		    add_to(walk, VARPTR); \
-		} \
+    if (BUCKET_HILLCLIMB){ \
+	if (VARPTR->make > 0){ \
+	    if (! is_in(walk, VARPTR)){ \
+		add_to(walk, VARPTR); \
 	    } \
-	    else { \
-		if (is_in(walk, VARPTR)){\
-		    delete_from(walk, VARPTR);\
-		    if (flag_only_unsat){\
-			delete_if_in(down, VARPTR);\
-			delete_if_in(up, VARPTR);\
-			delete_if_in(sideways, VARPTR);\
-		    }\
-		} \
-	    }\
-	    if (!flag_only_unsat || VARPTR->make > 0){\
-		if (VARPTR->diff > 0){ \
-		    if (! is_in(down, VARPTR)){ \
-			delete_if_in(up, VARPTR); \
-			delete_if_in(sideways, VARPTR); \
-			add_to(down, VARPTR); \
-		    } \
-		} \
-		else if (VARPTR->diff == 0){ \
-		    if (! is_in(sideways, VARPTR)){ \
-			delete_if_in(up, VARPTR); \
-			delete_if_in(down, VARPTR); \
-			add_to(sideways, VARPTR); \
-		    } \
-		} \
-		else { \
-		    if (! is_in(up, VARPTR)){ \
-			delete_if_in(down, VARPTR); \
-			delete_if_in(sideways, VARPTR); \
-			add_to(up, VARPTR); \
-		    } \
-		} \
-	    }\
-	}\
+	} \
 	else { \
-	    if (VARPTR->make > 0){ \
-		if (! is_in(walk, VARPTR)){ \
-		    add_to(walk, VARPTR); \
-		} \
+	    if (is_in(walk, VARPTR)){\
+		delete_from(walk, VARPTR);\
+		if (BUCKET_ONLY_UNSAT){\
+		    delete_if_in(down, VARPTR);\
+		    delete_if_in(up, VARPTR);\
+		    delete_if_in(sideways, VARPTR);\
+		}\
 	    } \
-	    else { \
-		if (is_in(walk, VARPTR)){\
-		    delete_from(walk, VARPTR);\
-		    if (flag_only_unsat){\
-			delete_if_in(maxdiff, VARPTR);\
-		    }\
+	}\
+	if (!BUCKET_ONLY_UNSAT || VARPTR->make > 0){\
+	    if (VARPTR->diff > 0){ \
+		if (! is_in(down, VARPTR)){ \
+		    delete_if_in(up, VARPTR); \
+		    delete_if_in(sideways, VARPTR); \
+		    add_to(down, VARPTR); \
 		} \
-	    }\
-	    if (!flag_only_unsat || VARPTR->make > 0){\
-		if (VARPTR->diff > current_max_diff){ \
-		    empty_out(maxdiff); \
-		    add_to(maxdiff, VARPTR); \
-		    current_max_diff = VARPTR->diff; \
+	    } \
+	    else if (VARPTR->diff == 0){ \
+		if (! is_in(sideways, VARPTR)){ \
+		    delete_if_in(up, VARPTR); \
+		    delete_if_in(down, VARPTR); \
+		    add_to(sideways, VARPTR); \
 		} \
-		else {\
-		    if (is_in(maxdiff, VARPTR)){ \
-			if (VARPTR->diff < current_max_diff){ \
-			    delete_from(maxdiff, VARPTR); \
-			} \
-		    }\
-		    else {\
-			if (VARPTR->diff == current_max_diff){ \
-			    add_to(maxdiff, VARPTR); \
-			} \
-		    } \
+	    } \
+	    else { \
+		if (! is_in(up, VARPTR)){ \
+		    delete_if_in(down, VARPTR); \
+		    delete_if_in(sideways, VARPTR); \
+		    add_to(up, VARPTR); \
 		} \
 	    } \
 	}\
     }\
+    else { \
+	if (VARPTR->make > 0){ \
+	    if (! is_in(walk, VARPTR)){ \
+		add_to(walk, VARPTR); \
+	    } \
+	} \
+	else { \
+	    if (is_in(walk, VARPTR)){\
+		delete_from(walk, VARPTR);\
+		if (BUCKET_ONLY_UNSAT){\
+		    score_delete_if_in(VARPTR);\
+		}\
+	    } \
+	}\
+	if (!BUCKET_ONLY_UNSAT || VARPTR->make > 0){\
+	    score_adjust(VARPTR); \
+	} \
+    }\
 }
 
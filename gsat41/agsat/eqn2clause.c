@@ -11,8 +11,6 @@
 #include <string.h>
 #include <math.h>
 
-#define MAX_TERMS 1000
-
 typedef int literal;
 
 typedef int relation;
@@ -26,36 +24,126 @@ typedef int relation;
 
 extern char * relation_names[];
 
+typedef struct {
+    literal lit;
+    int coeff; } term;
+
 typedef struct {
     relation reln;
     int c0;
     int c0upper;
     int sumcoeff;
     int numterms;
-    struct {
-	literal lit;
-	int coeff; } body[ MAX_TERMS ]; } equation;
+    int maxterms;
+    term * body; } equation;	/* body[1..numterms] */
 
 typedef struct {
     int len;
-    literal lit[ MAX_TERMS]; } clause;
+    int maxlen;
+    literal * lit; } clause;	/* lit[1..len] */
+
+/* Encodings of a row sum c_i l_i >= c0 */
+typedef int encoding;
+#define ENCODE_AUTO 0
+#define ENCODE_DIRECT 1		/* every subset of lits, no new vars */
+#define ENCODE_COUNTER 2	/* sequential counter, for cardinality rows */
+#define ENCODE_TOTALIZER 3	/* totalizer, for cardinality rows */
+#define ENCODE_BDD 4		/* decision diagram over the coefficients */
+#define ENCODE_ADDER 5		/* adder network and comparator */
+#define HIGHEST_ENCODING 5
 
+extern char * encoding_names[];
+
+#define DIRECT_LIMIT 1000	/* most clauses from a direct encoding in auto */
+#define BDD_LIMIT 100000	/* most nodes in a decision diagram */
+#define ADDER_BITS 64
 
 /****************/
 /*  Global data */
 /****************/
 
 static equation eqn;
+static equation * eqns = NULL;	/* all the rows, read before any is converted */
+static int numeqns = 0;
+static int maxeqns = 0;
 static int flag_pretty = 0;
 static int flag_offset = 0;
+static int flag_false = 0;
+static encoding flag_encode = ENCODE_AUTO;
+static int direct_limit = DIRECT_LIMIT;
+static int bdd_limit = BDD_LIMIT;
+static literal next_aux = 0;	/* next new var; 0 = one above the rows' vars */
+static int num_clauses = 0;	/* clauses written so far */
+static int encoded_rows[HIGHEST_ENCODING + 1];
+static int encoded_clauses[HIGHEST_ENCODING + 1];
+static int encoded_aux[HIGHEST_ENCODING + 1];
 
 char * relation_names[] = {
     "between", "<=", ">=", "<", "=", ">" };
 
+char * encoding_names[] = {
+    "auto", "direct", "counter", "totalizer", "bdd", "adder" };
+
 /*****************/
 /*  Input/Output */
 /*****************/
 
+void *
+xmalloc( PROTO(int) n)
+PARAMS( int n; )
+{
+    void * p;
+    if ((p = malloc((unsigned) (n > 0 ? n : 1))) == NULL){
+	fprintf(stderr, "Out of memory\n");
+	exit(-1);
+    }
+    return p;
+}
+
+void *
+xrealloc( PROTO(void *) p, PROTO(int) n)
+PARAMS( void * p; int n; )
+{
+    if ((p = (p == NULL) ? malloc((unsigned) n) : realloc(p, (unsigned) n)) == NULL){
+	fprintf(stderr, "Out of memory\n");
+	exit(-1);
+    }
+    return p;
+}
+
+void
+grow_eqn( PROTO(equation *) eqnp, PROTO(int) len)
+PARAMS( equation * eqnp; int len; )
+     /* Make room for terms body[1..len] */
+{
+    if (len < eqnp->maxterms) return;
+    eqnp->maxterms = 2 * len + 16;
+    eqnp->body = (term *) xrealloc((void *) eqnp->body, eqnp->maxterms * sizeof(term));
+}
+
+void
+grow_clause( PROTO(clause *) clp, PROTO(int) len)
+PARAMS( clause * clp; int len; )
+     /* Make room for lits lit[1..len] */
+{
+    if (len < clp->maxlen) return;
+    clp->maxlen = 2 * len + 16;
+    clp->lit = (literal *) xrealloc((void *) clp->lit, clp->maxlen * sizeof(literal));
+}
+
+void
+copy_eqn( PROTO(equation *) to, PROTO(equation *) from)
+PARAMS( equation * to; equation * from; )
+{
+    int i;
+    *to = *from;
+    to->maxterms = 0;
+    to->body = NULL;
+    grow_eqn(to, from->numterms);
+    for (i = 1; i <= from->numterms; i++)
+      to->body[i] = from->body[i];
+}
+
 void
 write_clause( PROTO(clause *) clp)
 PARAMS( clause * clp; )
@@ -64,6 +152,22 @@ PARAMS( clause * clp; )
     for (i=1; i<= clp->len; i++)
       printf(" %i ", clp->lit[i]);
     printf("\n");
+    num_clauses++;
+}
+
+void
+write_lits( PROTO(literal) a, PROTO(literal) b, PROTO(literal) c, PROTO(literal) d)
+PARAMS( literal a; literal b; literal c; literal d; )
+     /* Write the clause of those of a, b, c, d that are not 0 */
+{
+    static clause cl;
+    grow_clause(&cl, 4);
+    cl.len = 0;
+    if (a) cl.lit[++cl.len] = a;
+    if (b) cl.lit[++cl.len] = b;
+    if (c) cl.lit[++cl.len] = c;
+    if (d) cl.lit[++cl.len] = d;
+    write_clause(&cl);
 }
 
 void
@@ -79,8 +183,8 @@ write_false()
     if (flag_pretty)
       printf("#  FALSE\n");
     printf("1\n-1\n");
-    /* Eliminate the rest of the input */
-    while (getchar()!=EOF);
+    /* Nothing else matters */
+    flag_false = 1;
 }
 
 int
@@ -124,10 +228,7 @@ PARAMS( equation * eqnp; )
 	}
 	coeff = read_int();
 	if (coeff != 0){
-	    if (++len >= MAX_TERMS){
-		fprintf(stderr, "Too many terms\n");
-		exit(-1);
-	    }
+	    grow_eqn(eqnp, ++len);
 	    eqnp->body[len].lit = lit;
 	    eqnp->body[len].coeff = coeff;
 	}
@@ -166,7 +267,7 @@ PARAMS( equation * eqnp; )
     for (i = 1; i <= eqnp->numterms; i++){
 	coeff = eqnp->body[i].coeff;
 	if (i>1 && coeff>=0) printf("+ ");
-	if (coeff<0) { 
+	if (coeff<0) {
 	    printf("- ");
 	    coeff *= -1;
 	}
@@ -210,8 +311,8 @@ PARAMS( int lower; int upper; )
 	      ? sort_terms_aux.body[j++]
 		: ( j > upper)
 		  ? sort_terms_aux.body[i++]
-		    : (sort_terms_aux.body[i].coeff >= sort_terms_aux.body[j].coeff) 
-		      ? sort_terms_aux.body[i++] 
+		    : (sort_terms_aux.body[i].coeff >= sort_terms_aux.body[j].coeff)
+		      ? sort_terms_aux.body[i++]
 			: sort_terms_aux.body[j++];
     }
 }
@@ -222,6 +323,7 @@ PARAMS( equation * eqnp; )
      /* Sort the terms so that those with the largest coefficients
 	appear first */
 {
+    grow_eqn(&sort_terms_aux, eqnp->numterms);
     sort_terms_eqnp = eqnp;
     sort_terms_mergesort( 1, eqnp->numterms );
 }
@@ -229,6 +331,7 @@ PARAMS( equation * eqnp; )
 static clause choose_cl;
 static equation * choose_eqnp;
 static void (* choose_clfun)( PROTO(clause *) );
+static int choose_count;
 
 int
 choose_recurse( PROTO(int) head, PROTO(int) startat, PROTO(int) needed)
@@ -246,7 +349,8 @@ PARAMS( int head; int startat; int needed; )
     }
     head++;
     foundflag = 0;
-    for ( ; startat <= choose_eqnp->numterms; startat++){
+    /* choose_count only grows when counting */
+    for ( ; startat <= choose_eqnp->numterms && choose_count <= direct_limit; startat++){
 	choose_cl.lit[head] = choose_eqnp->body[startat].lit;
 	newneeded = needed - choose_eqnp->body[startat].coeff;
 	if (choose_recurse(head, startat + 1, newneeded))
@@ -272,12 +376,432 @@ void (* clfun)();
 	constructed. */
 {
     sort_terms(eqnp);
+    grow_clause(&choose_cl, eqnp->numterms);
     choose_clfun = clfun;
     choose_eqnp = eqnp;
     choose_cl.len = 0;
+    choose_count = 0;
     (void) choose_recurse( 0, 1, amt );
 }
 
+void
+count_clause( PROTO(clause *) clp)
+PARAMS( clause * clp; )
+{
+    choose_count++;
+}
+
+int
+count_direct( PROTO(equation *) eqnp)
+PARAMS( equation * eqnp; )
+     /* Number of clauses in the direct encoding of a >= row, or
+	direct_limit + 1 if there are more */
+{
+    choose( eqnp, eqnp->sumcoeff + 1 - eqnp->c0, count_clause );
+    return choose_count;
+}
+
+
+/*****************************************************/
+/*  Encodings with new vars                          */
+/*                                                   */
+/*  Each takes a >= row with positive coefficients,  */
+/*  0 < c0 <= sumcoeff, and numbers its new vars     */
+/*  from next_aux.  The clauses only force the new   */
+/*  vars one way, which is all that satisfiability   */
+/*  needs: any assignment satisfying the row extends */
+/*  to one satisfying the clauses, and no other does */
+/*****************************************************/
+
+/* Cardinality: at least k of the lits l[1..n].  Counting the true
+   lits up to k and asking for k of them does; so does counting the
+   false lits up to n-k+1 and forbidding that many, and the smaller
+   cutoff c makes the smaller encoding.  Counting up forces the counts
+   up from the lits and counting down forces the lits from the counts.
+   The counter keeps s(i,j), j of the first i lits counted, in about
+   2nc clauses. */
+
+double
+counter_size( PROTO(int) n, PROTO(int) c, PROTO(int) up)
+PARAMS( int n; int c; int up; )
+{
+    if (!up) return c + 1 + (n - 1) * (2.0 * c - 1);
+    if (c == 1) return (double) n;
+    return c + (n - 2) * (2.0 * c - 1);
+}
+
+void
+encode_counter( PROTO(literal *) l, PROTO(int) n, PROTO(int) k, PROTO(int) up)
+PARAMS( literal * l; int n; int k; int up; )
+{
+    int i, j, m;
+    literal base;
+
+    base = next_aux;
+#define s(I,J) (base + ((I) - 1) * m + (J) - 1)
+    if (!up){
+	m = k;
+	next_aux += n * m;
+	write_lits(-s(1,1), l[1], 0, 0);
+	for (j = 2; j <= m; j++)
+	  write_lits(-s(1,j), 0, 0, 0);
+	for (i = 2; i <= n; i++){
+	    write_lits(-s(i,1), s(i-1,1), l[i], 0);
+	    for (j = 2; j <= m; j++){
+		write_lits(-s(i,j), s(i-1,j), l[i], 0);
+		write_lits(-s(i,j), s(i-1,j), s(i-1,j-1), 0);
+	    }
+	}
+	write_lits(s(n,m), 0, 0, 0);
+	return;
+    }
+
+    /* at most m of the lits false */
+    m = n - k;
+    if (m == 0){
+	for (i = 1; i <= n; i++) write_lits(l[i], 0, 0, 0);
+	return;
+    }
+    next_aux += (n - 1) * m;
+    write_lits(l[1], s(1,1), 0, 0);
+    for (j = 2; j <= m; j++)
+      write_lits(-s(1,j), 0, 0, 0);
+    for (i = 2; i < n; i++){
+	write_lits(l[i], s(i,1), 0, 0);
+	write_lits(-s(i-1,1), s(i,1), 0, 0);
+	for (j = 2; j <= m; j++){
+	    write_lits(l[i], -s(i-1,j-1), s(i,j), 0);
+	    write_lits(-s(i-1,j), s(i,j), 0, 0);
+	}
+	write_lits(l[i], -s(i-1,m), 0, 0);
+    }
+    write_lits(l[n], -s(n-1,m), 0, 0);
+#undef s
+}
+
+/* The totalizer counts each half in unary and merges the counts up a
+   binary tree, each count cut off at c; at most n log n new vars. */
+
+static double totalizer_clauses;
+
+int
+totalizer_count( PROTO(int) n, PROTO(int) c)
+PARAMS( int n; int c; )
+     /* Adds about the clauses of a subtree over n lits to
+	totalizer_clauses; returns the length of its count */
+{
+    int p, a, b, i;
+
+    if (n == 1) return 1;
+    a = totalizer_count(n / 2, c);
+    b = totalizer_count(n - n / 2, c);
+    p = (n < c) ? n : c;
+    /* pairs 0 <= i <= a, 0 <= j <= b with 1 <= i + j <= p */
+    for (i = 0; i <= a && i <= p; i++)
+      totalizer_clauses += ((b < p - i) ? b : p - i) + (i ? 1 : 0);
+    return p;
+}
+
+double
+totalizer_size( PROTO(int) n, PROTO(int) c)
+PARAMS( int n; int c; )
+{
+    totalizer_clauses = 1.0;
+    (void) totalizer_count(n, c);
+    return totalizer_clauses;
+}
+
+int
+totalizer_build( PROTO(literal *) l, PROTO(int) n, PROTO(int) c, PROTO(int) up, PROTO(literal *) out)
+PARAMS( literal * l; int n; int c; int up; literal * out; )
+     /* Count the lits l[1..n], or their negations if up, into
+	out[1..p], out[t] standing for t of them; returns p */
+{
+    literal * a, * b;
+    int p, pa, pb, i, j;
+
+    if (n == 1){
+	out[1] = up ? -l[1] : l[1];
+	return 1;
+    }
+    a = (literal *) xmalloc((c + 2) * sizeof(literal));
+    b = (literal *) xmalloc((c + 2) * sizeof(literal));
+    pa = totalizer_build(l, n / 2, c, up, a);
+    pb = totalizer_build(l + n / 2, n - n / 2, c, up, b);
+    p = (n < c) ? n : c;
+    for (i = 1; i <= p; i++) out[i] = next_aux++;
+    for (i = 0; i <= pa; i++)
+      for (j = 0; j <= pb; j++)
+	if (up && i + j >= 1 && i + j <= p)
+	  write_lits(i ? -a[i] : 0, j ? -b[j] : 0, out[i + j], 0);
+	else if (!up && i + j + 1 <= p)
+	  write_lits(-out[i + j + 1], i < pa ? a[i + 1] : 0, j < pb ? b[j + 1] : 0, 0);
+    free((char *) a);
+    free((char *) b);
+    return p;
+}
+
+void
+encode_totalizer( PROTO(literal *) l, PROTO(int) n, PROTO(int) k, PROTO(int) up)
+PARAMS( literal * l; int n; int k; int up; )
+{
+    literal * out;
+    int c;
+
+    c = up ? n - k + 1 : k;
+    out = (literal *) xmalloc((c + 2) * sizeof(literal));
+    (void) totalizer_build(l, n, c, up, out);
+    write_lits(up ? -out[c] : out[c], 0, 0, 0);
+    free((char *) out);
+}
+
+/* Weighted rows as a decision diagram: node (i, need) stands for
+   sum_{j>=i} c_j l_j >= need, with children (i+1, need-c_i) when l_i
+   is true and (i+1, need) when it is false.  Equal nodes are shared,
+   so there are at most n times the distinct needs; each node costs
+   two clauses. */
+
+#define BDD_TRUE 0
+#define BDD_FALSE (-1)
+#define BDD_ABORT (-2)
+
+static equation * bdd_eqnp;
+static int * bdd_rest;		/* bdd_rest[i] = sum of c_j, j >= i */
+static int bdd_nodes;
+static int * bdd_term, * bdd_need, * bdd_hi, * bdd_lo;	/* of nodes 1..bdd_nodes */
+static int * bdd_table;		/* hash of (term, need) to node, 0 = empty */
+static int bdd_table_size;
+
+int
+bdd_build( PROTO(int) i, PROTO(int) need)
+PARAMS( int i; int need; )
+     /* Returns the node for (i, need) */
+{
+    unsigned h;
+    int node, hi, lo;
+
+    if (need <= 0) return BDD_TRUE;
+    if (need > bdd_rest[i]) return BDD_FALSE;
+    h = ((unsigned) i * 2654435761U ^ (unsigned) need * 40503U) & (bdd_table_size - 1);
+    while ((node = bdd_table[h]) != 0){
+	if (bdd_term[node] == i && bdd_need[node] == need) return node;
+	h = (h + 1) & (bdd_table_size - 1);
+    }
+    if (bdd_nodes >= bdd_limit) return BDD_ABORT;
+    node = ++bdd_nodes;
+    bdd_table[h] = node;
+    bdd_term[node] = i;
+    bdd_need[node] = need;
+    if ((hi = bdd_build(i + 1, need - bdd_eqnp->body[i].coeff)) == BDD_ABORT) return BDD_ABORT;
+    if ((lo = bdd_build(i + 1, need)) == BDD_ABORT) return BDD_ABORT;
+    bdd_hi[node] = hi;
+    bdd_lo[node] = lo;
+    return node;
+}
+
+int
+encode_bdd( PROTO(equation *) eqnp)
+PARAMS( equation * eqnp; )
+     /* Returns 0, writing nothing, if the diagram passes bdd_limit nodes */
+{
+    int i, n, root, node;
+    literal base;
+
+    n = eqnp->numterms;
+    sort_terms(eqnp);
+    bdd_eqnp = eqnp;
+    bdd_rest = (int *) xmalloc((n + 2) * sizeof(int));
+    bdd_rest[n + 1] = 0;
+    for (i = n; i >= 1; i--)
+      bdd_rest[i] = bdd_rest[i + 1] + eqnp->body[i].coeff;
+    if (bdd_term == NULL){
+	bdd_term = (int *) xmalloc((bdd_limit + 1) * sizeof(int));
+	bdd_need = (int *) xmalloc((bdd_limit + 1) * sizeof(int));
+	bdd_hi = (int *) xmalloc((bdd_limit + 1) * sizeof(int));
+	bdd_lo = (int *) xmalloc((bdd_limit + 1) * sizeof(int));
+	for (bdd_table_size = 1; bdd_table_size < 2 * bdd_limit; bdd_table_size *= 2);
+	bdd_table = (int *) xmalloc(bdd_table_size * sizeof(int));
+    }
+    for (i = 0; i < bdd_table_size; i++) bdd_table[i] = 0;
+    bdd_nodes = 0;
+
+    root = bdd_build(1, eqnp->c0);
+    free((char *) bdd_rest);
+    if (root == BDD_ABORT) return 0;
+
+    base = next_aux - 1;
+    next_aux += bdd_nodes;
+    for (node = 1; node <= bdd_nodes; node++){
+	if (bdd_hi[node] > 0)
+	  write_lits(-(base + node), base + bdd_hi[node], 0, 0);
+	if (bdd_lo[node] == BDD_FALSE)
+	  write_lits(-(base + node), eqnp->body[bdd_term[node]].lit, 0, 0);
+	else if (bdd_lo[node] > 0)
+	  write_lits(-(base + node), eqnp->body[bdd_term[node]].lit, base + bdd_lo[node], 0);
+    }
+    write_lits(base + root, 0, 0, 0);
+    return 1;
+}
+
+/* Adders: each bit of each coefficient puts its lit in the bucket of
+   that bit; full and half adders then sum each bucket down to one lit,
+   carrying into the next, and a comparator checks the binary sum
+   against c0.  The adders are defined both ways, since a sum bit may
+   need to be false; about 14 clauses per bit of the coefficients. */
+
+static literal * adder_bucket[ADDER_BITS];
+static int adder_len[ADDER_BITS], adder_max[ADDER_BITS];
+
+void
+adder_push( PROTO(int) bit, PROTO(literal) lit)
+PARAMS( int bit; literal lit; )
+{
+    if (bit >= ADDER_BITS){
+	fprintf(stderr, "Coefficients too large\n");
+	exit(-1);
+    }
+    if (adder_len[bit] >= adder_max[bit]){
+	adder_max[bit] = 2 * adder_max[bit] + 16;
+	adder_bucket[bit] = (literal *)
+	  xrealloc((void *) adder_bucket[bit], adder_max[bit] * sizeof(literal));
+    }
+    adder_bucket[bit][adder_len[bit]++] = lit;
+}
+
+void
+write_xor( PROTO(literal) a, PROTO(literal) b, PROTO(literal) c, PROTO(literal) s)
+PARAMS( literal a; literal b; literal c; literal s; )
+     /* s = a xor b xor c, or a xor b if c is 0 */
+{
+    int k, parity;
+
+    for (k = 0; k < (c ? 8 : 4); k++){
+	parity = (k & 1) ^ ((k >> 1) & 1) ^ ((k >> 2) & 1);
+	write_lits((k & 1) ? -a : a, (k & 2) ? -b : b,
+		   c ? ((k & 4) ? -c : c) : 0, parity ? s : -s);
+    }
+}
+
+void
+encode_adder( PROTO(equation *) eqnp)
+PARAMS( equation * eqnp; )
+{
+    int i, bit, nbits;
+    literal a, b, c, s, carry, g, prev, out;
+
+    for (bit = 0; bit < ADDER_BITS; bit++) adder_len[bit] = 0;
+    nbits = 0;
+    for (i = 1; i <= eqnp->numterms; i++)
+      for (bit = 0; (eqnp->body[i].coeff >> bit) != 0; bit++)
+	if ((eqnp->body[i].coeff >> bit) & 1)
+	  adder_push(bit, eqnp->body[i].lit);
+
+    for (bit = 0; bit < ADDER_BITS && (bit < 32 || adder_len[bit] > 0); bit++){
+	while (adder_len[bit] >= 2){
+	    a = adder_bucket[bit][--adder_len[bit]];
+	    b = adder_bucket[bit][--adder_len[bit]];
+	    c = (adder_len[bit] > 0) ? adder_bucket[bit][--adder_len[bit]] : 0;
+	    s = next_aux++;
+	    carry = next_aux++;
+	    write_xor(a, b, c, s);
+	    write_lits(-a, -b, carry, 0);
+	    write_lits(a, -carry, c ? b : 0, 0);
+	    write_lits(b, -carry, c ? c : 0, 0);
+	    if (c){
+		write_lits(-a, -c, carry, 0);
+		write_lits(-b, -c, carry, 0);
+		write_lits(a, c, -carry, 0);
+	    }
+	    adder_push(bit, s);
+	    adder_push(bit + 1, carry);
+	}
+	if (adder_len[bit] > 0) nbits = bit + 1;
+    }
+
+    /* g_bit true only if the sum's bits 0..bit are at least c0's */
+    prev = 0;
+    for (bit = 0; bit < nbits; bit++){
+	out = adder_len[bit] ? adder_bucket[bit][0] : 0;
+	g = next_aux++;
+	if (bit < 31 && ((eqnp->c0 >> bit) & 1)){
+	    write_lits(-g, out, 0, 0);
+	    if (prev) write_lits(-g, prev, 0, 0);
+	}
+	else if (prev)
+	  write_lits(-g, out, prev, 0);
+	prev = g;
+    }
+    write_lits(prev, 0, 0, 0);
+}
+
+
+/******************/
+/*  Row encoding  */
+/******************/
+
+void
+encode_ge_eqn( PROTO(equation *) eqnp)
+PARAMS( equation * eqnp; )
+     /* Encode a >= row with positive coefficients and 0 < c0 <= sumcoeff,
+	picking the encoding by size unless -encode fixed it */
+{
+    literal * l;
+    int i, n, k, c, up, cardinality, clauses;
+    literal aux;
+    encoding how;
+
+    clauses = num_clauses;
+    aux = next_aux;
+    how = flag_encode;
+
+    if (how == ENCODE_AUTO && count_direct(eqnp) <= direct_limit)
+      how = ENCODE_DIRECT;
+    if (how == ENCODE_DIRECT){
+	choose( eqnp, eqnp->sumcoeff + 1 - eqnp->c0, write_clause );
+    }
+    else {
+	/* A coefficient above c0 counts only as c0 */
+	cardinality = 1;
+	for (i = 1; i <= eqnp->numterms; i++){
+	    if (eqnp->body[i].coeff > eqnp->c0)
+	      eqnp->body[i].coeff = eqnp->c0;
+	    if (eqnp->body[i].coeff != eqnp->body[1].coeff)
+	      cardinality = 0;
+	}
+	n = eqnp->numterms;
+	if (cardinality && how != ENCODE_BDD && how != ENCODE_ADDER){
+	    k = (eqnp->c0 + eqnp->body[1].coeff - 1) / eqnp->body[1].coeff;
+	    up = (n - k + 1 < k);
+	    c = up ? n - k + 1 : k;
+	    if (how != ENCODE_COUNTER && how != ENCODE_TOTALIZER)
+	      how = (c > 1 && totalizer_size(n, c) < counter_size(n, c, up))
+		? ENCODE_TOTALIZER : ENCODE_COUNTER;
+	    l = (literal *) xmalloc((n + 1) * sizeof(literal));
+	    for (i = 1; i <= n; i++) l[i] = eqnp->body[i].lit;
+	    if (how == ENCODE_COUNTER)
+	      encode_counter(l, n, k, up);
+	    else
+	      encode_totalizer(l, n, k, up);
+	    free((char *) l);
+	}
+	else {
+	    if (how != ENCODE_ADDER){
+		how = ENCODE_BDD;
+		if (!encode_bdd(eqnp)) how = ENCODE_ADDER;
+	    }
+	    if (how == ENCODE_ADDER)
+	      encode_adder(eqnp);
+	}
+    }
+
+    encoded_rows[how]++;
+    encoded_clauses[how] += num_clauses - clauses;
+    encoded_aux[how] += next_aux - aux;
+    if (flag_pretty)
+      printf("#  %s: %i clauses, %i new vars\n", encoding_names[how],
+	     num_clauses - clauses, next_aux - aux);
+}
+
 void
 convert_ge_eqn( PROTO(equation *) eqnp)
 PARAMS( equation * eqnp; )
@@ -306,7 +830,7 @@ PARAMS( equation * eqnp; )
 	write_false();
     }
     else {
-	choose( eqnp, eqnp->sumcoeff + 1 - eqnp->c0, write_clause );
+	encode_ge_eqn(eqnp);
     }
 }
 
@@ -339,19 +863,21 @@ PARAMS( equation * eqnp; )
 	convert_eqn(eqnp);
 	break;
       case EQUAL:
-	eqn2 = *eqnp;
+	copy_eqn(&eqn2, eqnp);
 	eqnp->reln = LESS_EQUAL;
 	eqn2.reln = GREATER_EQUAL;
 	convert_eqn(eqnp);
-	convert_eqn(&eqn2);
+	if (!flag_false) convert_eqn(&eqn2);
+	free((char *) eqn2.body);
 	break;
       case LOWER_UPPER:
-	eqn2 = *eqnp;
+	copy_eqn(&eqn2, eqnp);
 	eqnp->reln = GREATER_EQUAL;
 	eqn2.c0 = eqn2.c0upper;
 	eqn2.reln = LESS_EQUAL;
 	convert_eqn(eqnp);
-	convert_eqn(&eqn2);
+	if (!flag_false) convert_eqn(&eqn2);
+	free((char *) eqn2.body);
 	break;
       default:
 	fprintf(stderr, "Bad relation %i\n", eqnp->reln);
@@ -368,25 +894,61 @@ int
 main( PROTO(int) argc, PROTO(char * *) argv )
 PARAMS( int argc; char * * argv; )
 {
-    int i;
+    int i, j;
+    literal maxvar;
 
     for (i=1; i<argc; i++){
 	if (strcmp(argv[i], "-pretty")==0)
 	  flag_pretty = 1;
 	else if (strcmp(argv[i], "-offset")==0)
 	  flag_offset = 1;
+	else if (strcmp(argv[i], "-encode")==0 && i + 1 < argc){
+	    for (flag_encode = HIGHEST_ENCODING; flag_encode >= 0; flag_encode--)
+	      if (strcmp(argv[i + 1], encoding_names[flag_encode])==0) break;
+	    if (flag_encode < 0){
+		fprintf(stderr, "Bad encoding %s\n", argv[i + 1]);
+		exit(-1);
+	    }
+	    i++;
+	}
+	else if (strcmp(argv[i], "-direct")==0 && i + 1 < argc)
+	  direct_limit = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-bdd")==0 && i + 1 < argc)
+	  bdd_limit = atoi(argv[++i]);
+	else if (strcmp(argv[i], "-aux")==0 && i + 1 < argc)
+	  next_aux = atoi(argv[++i]);
 	else {
 	    fprintf(stderr, "Bad option %s\n", argv[i]);
 	    exit(-1);
 	}
     }
-    
+    if (bdd_limit < 1) bdd_limit = 1;
+
+    /* New vars go above every var of the rows, so read them all first */
+    maxvar = 0;
     while (read_eqn(&eqn)){
+	if (numeqns >= maxeqns){
+	    maxeqns = 2 * maxeqns + 64;
+	    eqns = (equation *) xrealloc((void *) eqns, maxeqns * sizeof(equation));
+	}
+	copy_eqn(&eqns[numeqns++], &eqn);
+	for (j = 1; j <= eqn.numterms; j++)
+	  if (eqn.body[j].lit > maxvar) maxvar = eqn.body[j].lit;
+    }
+    if (next_aux <= maxvar)
+      next_aux = maxvar + 1;
+
+    for (i = 0; i < numeqns && !flag_false; i++){
 	if (flag_pretty)
-	  pretty_print_eqn(&eqn);
-	convert_eqn(&eqn);
+	  pretty_print_eqn(&eqns[i]);
+	convert_eqn(&eqns[i]);
+	free((char *) eqns[i].body);
     }
+    if (flag_pretty)
+      for (i = 1; i <= HIGHEST_ENCODING; i++)
+	if (encoded_rows[i])
+	  printf("#  %i rows by %s: %i clauses, %i new vars\n", encoded_rows[i],
+		 encoding_names[i], encoded_clauses[i], encoded_aux[i]);
     printf("%%\n0\n");
     return 0;
 }
-
@@ -0,0 +1,227 @@
+/* ampl.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* AMPL .nl files.  A wff file ending in ".nl" is an AMPL problem in
+   the ascii (type g) format, read in place of the ampl2eqn, eqn2clause
+   and gsat2sol programs of the agsat directory.  Only its header is
+   read with the wff: the wff has the AMPL vars and no clauses.  Once
+   the vars are numbered, its linear rows (the r and J segments) go
+   straight to the pseudo-Boolean rows of pb.c, with the relations
+   ampl2eqn passes on to eqn2clause.  At the end of the run the best
+   assignment is written to the .sol file next to the .nl file, as
+   gsat2sol writes it. */
+
+#include "gsat.h"
+#include "reorder.h"
+#include "pb.h"
+#include "ampl.h"
+#include "utils.h"
+
+#define AMPL_MAXLINE 1024
+#define AMPL_MAX_OPTIONS 10
+
+long ampl_options[AMPL_MAX_OPTIONS];	/* [0] = number, then the options */
+int ampl_num_constraints;
+
+typedef struct ampl_range_str {
+    int reln;
+    int left;
+    int right;
+} *ampl_range_ptr;
+
+static int
+ampl_get_line(PROTO(char *) line, PROTO(FILE *) fp)
+     /* Read a line, dropping the rest of one too long; 0 at end of file */
+PARAMS( char * line; FILE * fp; )
+{
+    int c, len;
+
+    if (fgets(line, AMPL_MAXLINE, fp) == NULL) return 0;
+    len = strlen(line);
+    if (len > 0 && line[len - 1] != '\n')
+      while ((c = fgetc(fp)) != EOF && c != '\n');
+    return 1;
+}
+
+static FILE *
+ampl_open_header(PROTO(char *) line)
+     /* Open the wff file and read its two header lines into ampl_options,
+	nvars and ampl_num_constraints; NULL if it is not type g */
+PARAMS( char * line; )
+{
+    FILE * fp;
+    char * s;
+    char * se;
+    int i;
+
+    if ((fp = fopen(wff_file, "r")) == NULL){
+	sprintf(ss, "ERROR: cannot open wff file %s\n", wff_file);
+	crash_and_burn(ss);
+    }
+    if (!ampl_get_line(line, fp) || line[0] != 'g'){
+	printf("AMPL file not ascii (type g)\n");
+	fclose(fp);
+	return NULL;
+    }
+    s = line;
+    if ((ampl_options[0] = strtol(++s, &se, 10)) != 0){
+	if (ampl_options[0] >= AMPL_MAX_OPTIONS) ampl_options[0] = AMPL_MAX_OPTIONS - 1;
+	for (i = 1; i <= ampl_options[0] && se > s; i++)
+	  ampl_options[i] = strtol(s = se, &se, 10);
+    }
+    if (!ampl_get_line(line, fp) ||
+	sscanf(line, "%d %d", &nvars, &ampl_num_constraints) != 2 ||
+	nvars <= 0 || ampl_num_constraints < 0){
+	fclose(fp);
+	return NULL;
+    }
+    return fp;
+}
+
+int
+read_in_nl_format()
+     /* The wff is the AMPL vars and no clauses; returns 0 if not a .nl file */
+{
+    FILE * fp;
+    char line[AMPL_MAXLINE];
+
+    printf("Trying to read AMPL nl-format\n");
+    if ((fp = ampl_open_header(line)) == NULL)
+      return 0;
+    fclose(fp);
+
+    nclauses = 0;
+    nlits = 0;
+    printf("nvars = %d\nnclauses = %d\nnlits = %d\nrows = %d\n",
+	   nvars, nclauses, nlits, ampl_num_constraints);
+    allocate_memory();
+    flag_format = FLAG_FORMAT_NL;
+    flag_pb = 1;
+    return 1;
+}
+
+void
+ampl_read_rows()
+     /* Hand the rows to pb_add_input_row; called by pb_read */
+{
+    FILE * fp;
+    char line[AMPL_MAXLINE];
+    ampl_range_ptr rhs;
+    int * terms;
+    int i, j, n, var, num_rows, max_terms;
+
+    if ((fp = ampl_open_header(line)) == NULL)
+      crash_and_burn("ERROR: bad AMPL header\n");
+    rhs = (ampl_range_ptr) malloc((size_t)((ampl_num_constraints + 1) * sizeof(struct ampl_range_str)));
+    max_terms = 64;
+    terms = (int *) malloc((size_t)(2 * max_terms * sizeof(int)));
+    if (rhs == NULL || terms == NULL)
+      crash_and_burn("ERROR: cannot allocate AMPL rows\n");
+
+    /* Constraint bodies must be linear */
+    do {
+	if (!ampl_get_line(line, fp))
+	  crash_and_burn("ERROR: AMPL file has no r segment\n");
+	if (line[0] == 'C'){
+	    if (!ampl_get_line(line, fp) || !(line[0] == 'n' && line[1] == '0'))
+	      crash_and_burn("ERROR: cannot read non-linear AMPL constraints\n");
+	}
+    } while (line[0] != 'r');
+
+    for (i = 0; i < ampl_num_constraints; i++){
+	rhs[i].right = 0;
+	if (!ampl_get_line(line, fp) ||
+	    sscanf(line, "%d %d", &rhs[i].reln, &rhs[i].left) != 2 ||
+	    (rhs[i].reln == 0 &&
+	     sscanf(line, "%*d %*d %d", &rhs[i].right) != 1)){
+	    sprintf(ss, "ERROR: bad bounds of AMPL row %d\n", i);
+	    crash_and_burn(ss);
+	}
+    }
+
+    num_rows = 0;
+    while (ampl_get_line(line, fp)){
+	if (line[0] != 'J') continue;
+	if (sscanf(line, "J%d %d", &i, &n) != 2 ||
+	    i < 0 || i >= ampl_num_constraints || n < 0){
+	    sprintf(ss, "ERROR: bad AMPL line %s", line);
+	    crash_and_burn(ss);
+	}
+	if (n > max_terms){
+	    max_terms = 2 * n;
+	    terms = (int *) realloc(terms, (size_t)(2 * max_terms * sizeof(int)));
+	    if (terms == NULL)
+	      crash_and_burn("ERROR: cannot allocate AMPL rows\n");
+	}
+	for (j = 0; j < n; j++){
+	    if (!ampl_get_line(line, fp) ||
+		sscanf(line, "%d %d", &var, &terms[2 * j + 1]) != 2 ||
+		var < 0 || var >= nvars){
+		sprintf(ss, "ERROR: bad term of AMPL row %d\n", i);
+		crash_and_burn(ss);
+	    }
+	    terms[2 * j] = internal_var(var + 1);
+	}
+	pb_add_input_row(terms, n, rhs[i].reln, rhs[i].left, rhs[i].right);
+	num_rows++;
+    }
+    if (num_rows != ampl_num_constraints){
+	sprintf(ss, "ERROR: AMPL file has %d rows, but %d J segments\n",
+		ampl_num_constraints, num_rows);
+	crash_and_burn(ss);
+    }
+    fclose(fp);
+    free((char *) rhs);
+    free((char *) terms);
+}
+
+void
+ampl_write_sol()
+     /* Write the best assignment to the .sol file, for AMPL to read */
+{
+    FILE * fp;
+    char sol_file[MAXLINE + 8];
+    int i, len;
+
+    strcpy(sol_file, wff_file);
+    len = strlen(sol_file);
+    if (len >= 3 && strcmp(".nl", &sol_file[len - 3]) == 0)
+      sol_file[len - 3] = 0;
+    strcat(sol_file, ".sol");
+    if ((fp = fopen(sol_file, "w")) == NULL){
+	sprintf(ss, "ERROR: cannot open sol file %s\n", sol_file);
+	crash_and_burn(ss);
+    }
+
+    fprintf(fp, ";;; ");
+    fprintf(fp, program_name);
+    fprintf(fp, "(setq *gsat-wff-file* \"%s\")\n", wff_file);
+    fprintf(fp, "(setq *gsat-nvars* %d)\n", nvars);
+    fprintf(fp, "(setq *gsat-max-flips* %d)\n", max_flips);
+    fprintf(fp, "(setq *gsat-max-tries* %d)\n", max_tries);
+    fprintf(fp, "(setq *gsat-best-num-bad* %d)\n", best_num_bad);
+    if (best_num_bad > 0)
+      fprintf(fp, ";;; Sorry, failed to find assignment!\n");
+    else
+      fprintf(fp, ";;; Satisying assignment found!\n");
+    fprintf(fp, "\n");
+
+    fprintf(fp, "Options\n");
+    for (i = 0; i <= ampl_options[0]; i++)
+      fprintf(fp, "%ld\n", ampl_options[i]);
+    fprintf(fp, "%d\n%d\n%d\n%d\n", ampl_num_constraints, 0, nvars, nvars);
+    for (i = 1; i <= nvars; i++)
+      fprintf(fp, "%d\n", (assign[internal_var(i)].value_best > 0) ? 1 : 0);
+    fclose(fp);
+    printf("sol_file: %s\n", sol_file);
+}
@@ -0,0 +1,22 @@
+/* ampl.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef AMPL_H
+#define AMPL_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int read_in_nl_format, ());
+EXTERN_FUNCTION( void ampl_read_rows, ());
+EXTERN_FUNCTION( void ampl_write_sol, ());
+
+#endif
@@ -14,9 +14,15 @@
 #include "gsat.h"
 #include "urand.h"
 #include "anneal.h"
+#include "checkpoint.h"
+#include "score.h"
+#include "tempering.h"
 #include "utils.h"
 
 #define MAX_SCHEDULE_SIZE 1000
+#define ANNEAL_TABLE_SIZE 256	/* acceptance odds are cached for diffs -1 .. -255 */
+#define ANNEAL_REJECT (-1)	/* odds meaning exp() underflowed to 0: reject, no draw */
+#define ANNEAL_HALF_BITS 2097152	/* 2**21, for anneal_random_real */
 
 struct anneal_sched_str {
     int steps;
@@ -38,6 +44,8 @@ int anneal_infinite;		/* 1 = an infinite geometric sequence is specified */
 int anneal_pick_randomly;	/* 0 = sequence, 1 = random */
 int anneal_count_flips;		/* 0 = schedule specifies number of picks;
 				   1 = schedule specifies number of flips */
+int anneal_nfold;		/* 1 = pick without rejections when possible */
+int anneal_nfold_nulls;		/* rejections accounted for by such picks */
 int anneal_current_line;	/* current line in the annealing schedule */
 int anneal_current_step;	/* current step within the current line */
 int anneal_current_repeat;	/* number of times schedule has been repeated */
@@ -46,6 +54,9 @@ int anneal_cumulative;		/* total number steps so far */
 int anneal_total_length;	/* the maximum total length of the annealing schedule
 				   (for informational purposes only) */
 double anneal_current_temp;	/* current temperature */
+int anneal_temp_stamp = 1;	/* changed whenever anneal_current_temp changes */
+int anneal_odds[ANNEAL_TABLE_SIZE];	/* anneal_odds[-diff] = odds of accepting diff */
+int anneal_odds_stamp[ANNEAL_TABLE_SIZE];	/* anneal_temp_stamp when computed */
 
 
 static char helpmsg[] = "Format of annealing schedule:\n\
@@ -54,6 +65,10 @@ static char helpmsg[] = "Format of annealing schedule:\n\
 	sequential	- pick vars in sequence\n\
 	flips		- count each flip as a step (default)\n\
 	picks		- count each pick as a step\n\
+	nfold		- when picking randomly by flips at a positive\n\
+			  temperature, choose among the accepted moves\n\
+			  directly instead of rejecting proposals (default)\n\
+	metropolis	- always propose random vars and reject\n\
 (2) 1 or more lines of any of the following formats:\n\
 \n\
 (2a)  Pairs of steps and temperature; e.g.\n\
@@ -192,6 +207,8 @@ PARAMS(char * inputline;)
     anneal_sched_size = 0;
     anneal_pick_randomly = 1;
     anneal_count_flips = 1;
+    anneal_nfold = 1;
+    anneal_nfold_nulls = 0;
     anneal_sched_repeat = 0;
     anneal_repeat_max = -1;
     anneal_total_length = -1;
@@ -213,6 +230,10 @@ PARAMS(char * inputline;)
 	  anneal_count_flips = 1;
 	else if (strcmp(word1, "picks")== 0)
 	  anneal_count_flips = 0;
+	else if (strcmp(word1, "nfold")== 0)
+	  anneal_nfold = 1;
+	else if (strcmp(word1, "metropolis")== 0)
+	  anneal_nfold = 0;
 	else if (strcmp(word1, "end")==0)
 	  break;
 	else if (sscanf(inputline, " repeat %d %d", &anneal_sched_repeat, &anneal_repeat_max)==2) {
@@ -269,7 +290,10 @@ PARAMS(char * inputline;)
 	total_s += repeat_s * anneal_repeat_max;
     }  
 
-    if (!anneal_infinite){
+    if (flag_tempering){
+	/* the schedule is a ladder of temperatures; max_flips stands */
+    }
+    else if (!anneal_infinite){
 	if (anneal_count_flips){
 	    printf("Attention!  Resetting max_flips to %d\n", total_s);
 	    max_flips = total_s;
@@ -311,6 +335,7 @@ PARAMS(FILE * fp;)
 
     fprintf(fp, "anneal_file: %s\n", anneal_file);
     fprintf(fp, "anneal_total_length: %d\n", anneal_total_length);
+    fprintf(fp, "anneal_nfold_nulls: %d\n", anneal_nfold_nulls);
     fprintf(fp, "Annealing schedule:\n");
     fprintf(fp, "    steps     temp\n");
     if (anneal_pick_randomly != 0)
@@ -321,6 +346,10 @@ PARAMS(FILE * fp;)
       fprintf(fp, "flips\n");
     else
       fprintf(fp, "picks\n");
+    if (anneal_nfold != 0)
+      fprintf(fp, "nfold\n");
+    else
+      fprintf(fp, "metropolis\n");
     for (i=1; i<= anneal_sched_size; i++){
 	if (anneal_schedule[i].factor == 0.0)
 	  fprintf(fp, "  %6d    %6.2f\n", anneal_schedule[i].steps, 
@@ -355,6 +384,7 @@ anneal_initialize()
     anneal_cumulative = 0;
     anneal_current_repeat = 0;
     anneal_current_temp = anneal_schedule[1].temp;
+    anneal_temp_stamp++;
 }
 
 void
@@ -403,6 +433,7 @@ PARAMS( int var; int diff; )
 	anneal_current_temp *= anneal_schedule[anneal_current_line].factor;
 	if (anneal_schedule[anneal_current_line].floor) 
 	  anneal_current_temp = floor(anneal_current_temp);
+	anneal_temp_stamp++;
     }
     else {
 	anneal_current_line ++;
@@ -421,19 +452,145 @@ PARAMS( int var; int diff; )
 
 	}
 	anneal_current_temp = anneal_schedule[anneal_current_line].temp;
+	anneal_temp_stamp++;
     }
 }
 
 
+void
+anneal_set_temp(PROTO(double) temp)
+     /* Set the temperature from outside the schedule */
+PARAMS( double temp; )
+{
+    anneal_current_temp = temp;
+    anneal_temp_stamp++;
+}
+
+int
+anneal_ladder_size()
+     /* Number of lines in the schedule, when it is a temperature ladder */
+{
+    return anneal_sched_size;
+}
+
+double
+anneal_ladder_temp(PROTO(int) rung)
+     /* Temperature of line rung + 1 of the schedule */
+PARAMS( int rung; )
+{
+    return anneal_schedule[rung + 1].temp;
+}
+
+
+static int
+anneal_compute_odds(PROTO(int) diff)
+     /* Odds (relative to INT_PROB_BASE) of accepting an uphill move of
+	diff at the current temperature; INT_PROB_BASE and ANNEAL_REJECT
+	mean accept or reject without drawing, as random_01_prob does
+	for probabilities of exactly 1 and 0 */
+PARAMS( int diff; )
+{
+    double prob;
+
+    prob = exp (  ((double)diff * 100.0) / anneal_current_temp);
+    if (prob == 0.0) return ANNEAL_REJECT;
+    if (prob == 1.0) return INT_PROB_BASE;
+    return (int)( prob * INT_PROB_BASE );
+}
+
+static int
+anneal_odds_of(PROTO(int) diff)
+     /* Odds of accepting diff < 0 at a positive temperature.  The odds
+	for each diff are computed once per temperature. */
+PARAMS( int diff; )
+{
+    if (-diff >= ANNEAL_TABLE_SIZE)
+      return anneal_compute_odds(diff);
+    if (anneal_odds_stamp[-diff] != anneal_temp_stamp){
+	anneal_odds[-diff] = anneal_compute_odds(diff);
+	anneal_odds_stamp[-diff] = anneal_temp_stamp;
+    }
+    return anneal_odds[-diff];
+}
+
+static int
+anneal_accept(PROTO(int) diff)
+     /* Metropolis test for diff < 0 at a positive temperature */
+PARAMS( int diff; )
+{
+    int odds;
+
+    odds = anneal_odds_of(diff);
+    if (odds == ANNEAL_REJECT) return 0;
+    if (odds >= INT_PROB_BASE) return 1;
+    return random_01_odds(odds);
+}
+
+
+static double
+anneal_random_real()
+     /* Uniform random number in (0,1], with 42 bits */
+{
+    return ((random_1_to(ANNEAL_HALF_BITS) - 1) * (double)ANNEAL_HALF_BITS +
+	    random_1_to(ANNEAL_HALF_BITS)) / ((double)ANNEAL_HALF_BITS * ANNEAL_HALF_BITS);
+}
+
+static int
+anneal_nfold_pick()
+     /* Rejection-free pick: a var of the score buckets, chosen with
+	probability proportional to its odds of being accepted.  The
+	Metropolis loop would first have rejected a geometrically
+	distributed number of random proposals; that many are drawn and
+	added to null_count.  Returns 0 if no move has positive odds. */
+{
+    score_bucket_ptr sb;
+    double total, r, accept;
+    int d, odds, nulls;
+
+    total = 0.0;
+    for (d = score_max(); d >= score_low; d--){
+	sb = &score_bucket[d - score_low];
+	if (sb->len == 0) continue;
+	odds = (d >= 0) ? INT_PROB_BASE : anneal_odds_of(d);
+	if (odds > 0) total += (double)sb->len * odds;
+    }
+    if (total <= 0.0) return 0;
+
+    accept = total / ((double)nvars * INT_PROB_BASE);
+    if (accept < 1.0){
+	r = log(anneal_random_real()) / log(1.0 - accept);
+	nulls = (r < (double)(BIG - null_count)) ? (int)r : BIG - null_count;
+	null_count += nulls;
+	anneal_nfold_nulls += nulls;
+    }
+
+    r = anneal_random_real() * total;
+    for (d = score_top; d > score_low; d--){
+	sb = &score_bucket[d - score_low];
+	if (sb->len == 0) continue;
+	odds = (d >= 0) ? INT_PROB_BASE : anneal_odds_of(d);
+	if (odds > 0 && (r -= (double)sb->len * odds) <= 0.0) break;
+    }
+    /* round-off can leave r just above 0; then d is the lowest class */
+    while (score_bucket[d - score_low].len == 0 ||
+	   (d < 0 && anneal_odds_of(d) <= 0))
+      d++;
+    sb = &score_bucket[d - score_low];
+    return sb->vars[random_1_to(sb->len)];
+}
+
 
 int
 anneal_pick_var()
      /* Pick var to flip according to annealing schedule.
 	Returns 0 if end of schedule is reached. */
 {
-    double prob;
     int var, diff, busylimit;
 
+    if (flag_tempering && flip > 0 && flip % tempering_period == 0 &&
+	!tempering_exchange())
+      return 0;
+
     busylimit = 10000 * nvars;
     do {
 	if (anneal_current_line > anneal_sched_size) /* End of schedule reached */
@@ -455,10 +612,7 @@ anneal_pick_var()
 	}
 	else if (anneal_current_temp == -2){ 
 
-	    if (length_of(walk) > 0) {
-		var = random_member(walk);
-	    }
-	    else {
+	    if ((var = allowed_member_walk(1)) == 0) {
 		var = pick_greedy_var();
 	    }
 	    diff = assign[var].diff;
@@ -467,6 +621,11 @@ anneal_pick_var()
 	    sprintf(ss, "ERROR, bad annealing temp %f\n", anneal_current_temp);
 	    crash_and_burn(ss);
 	}
+	else if (anneal_nfold && anneal_pick_randomly && anneal_count_flips &&
+		 anneal_current_temp > 0 && !flag_hillclimb && !flag_only_unsat &&
+		 (var = anneal_nfold_pick()) != 0){
+	    diff = assign[var].diff;
+	}
 	else {
 	    if (anneal_pick_randomly && anneal_current_temp == 0 && current_max_diff == 0){
 		var = pick_greedy_var();
@@ -483,25 +642,16 @@ anneal_pick_var()
 	    if (diff < 0){
 		if (anneal_current_temp <= 0)
 		  var = 0;
-		else {
-		    
-		    /* printf("DEBUG!  arg to exp=%f\n",   ((double)diff * 100.0) / anneal_current_temp); */
-
-		    prob = exp (  ((double)diff * 100.0) / anneal_current_temp);
-
-		    /* printf("DEBUG!  diff=%d, temp=%f, prob=%f\n", diff, anneal_current_temp, prob); */
-
-		    if (random_01_prob(prob)==0){
-			var = 0;
-			/* printf("DEBUG!  random_01_prob returns 0!\n"); */
-		    }
-		}
+		else if (!anneal_accept(diff))
+		  var = 0;
 	    }
 	}
 
 	if (var == 0) null_count ++;
 
-	if (!anneal_count_flips || var != 0 || (anneal_current_temp == 0 && current_max_diff < 0)){
+	if (flag_tempering)
+	  ;			/* each replica keeps its rung's temperature */
+	else if (!anneal_count_flips || var != 0 || (anneal_current_temp == 0 && current_max_diff < 0)){
 	    anneal_current_step ++;
 	    if (anneal_current_step > anneal_schedule[anneal_current_line].steps ||
 		(anneal_current_temp == 0 && current_max_diff < 0))
@@ -512,3 +662,22 @@ anneal_pick_var()
     return var;
 }
 
+void
+anneal_checkpoint()
+     /* The schedule starts again each try; only the count carries on */
+{
+    checkpoint_data((char *) &anneal_nfold_nulls, (long) sizeof(int));
+}
+
+void
+anneal_checkpoint_try()
+     /* Where the try has got to in the schedule */
+{
+    checkpoint_data((char *) &anneal_current_line, (long) sizeof(int));
+    checkpoint_data((char *) &anneal_current_step, (long) sizeof(int));
+    checkpoint_data((char *) &anneal_current_repeat, (long) sizeof(int));
+    checkpoint_data((char *) &anneal_last_var_picked, (long) sizeof(int));
+    checkpoint_data((char *) &anneal_cumulative, (long) sizeof(int));
+    checkpoint_data((char *) &anneal_current_temp, (long) sizeof(double));
+    if (checkpoint_loading()) anneal_temp_stamp++;
+}
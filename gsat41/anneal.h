@@ -21,5 +21,10 @@ EXTERN_FUNCTION( int anneal_pick_var, () );
 EXTERN_FUNCTION( int random_01_prob, (double p ));
 EXTERN_FUNCTION( void anneal_initialize, ());
 EXTERN_FUNCTION( void anneal_gather_statistics, ());
+EXTERN_FUNCTION( void anneal_set_temp, (double temp));
+EXTERN_FUNCTION( int anneal_ladder_size, ());
+EXTERN_FUNCTION( double anneal_ladder_temp, (int rung));
+EXTERN_FUNCTION( void anneal_checkpoint, ());
+EXTERN_FUNCTION( void anneal_checkpoint_try, ());
 
 #endif
@@ -0,0 +1,353 @@
+/* ccanr.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Configuration checking with aspiration, after CCAnr (Cai & Su,
+   "Local search for Boolean Satisfiability with configuration
+   checking and subscore").  Two vars are neighbors if they appear in
+   a common clause.  A var's configuration has changed if one of its
+   neighbors has been flipped since it was last flipped; only such vars
+   are eligible for a greedy flip.  Each flip:
+
+   1. If some var with diff > 0 has a changed configuration, flip the
+      one with the greatest diff, ties going to the var flipped longest
+      ago.
+   2. Otherwise, if the greatest diff of any var exceeds the average
+      clause weight (aspiration), flip the oldest var of that diff.
+   3. Otherwise, add 1 to the weight of every false clause, smoothing
+      all weights towards the average once it exceeds ccanr_gamma, and
+      flip the oldest var of a random false clause.
+
+   The candidates of step 1 are kept on a list.  Only the flipped var
+   and its neighbors can change diff or configuration in a flip, so
+   the list is updated by a pass over the neighbors after update_diff.
+   The weights live in wff[].next as for the weight option. */
+
+#include "gsat.h"
+#include "score.h"
+#include "adjust_bucket.h"
+#include "ccanr.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define CCANR_RHO_DEFAULT 0.3
+
+int ccanr_gamma;		/* smooth when the average weight exceeds this */
+float ccanr_rho;		/* weight kept by a clause when smoothing */
+int ccanr_total_weight;		/* sum of the clause weights */
+int ccanr_greedy;		/* step 1 flips so far */
+int ccanr_aspirations;		/* step 2 flips so far */
+int ccanr_increases;		/* step 3 flips so far */
+int ccanr_smooths;		/* smoothings so far */
+
+int *ccanr_nbr_start = NULL;	/* neighbors of v are ccanr_nbr[ccanr_nbr_start[v] .. */
+int *ccanr_nbr = NULL;		/* ccanr_nbr_start[v+1] - 1] */
+char *ccanr_conf = NULL;	/* indexed by var: 1 = configuration changed */
+int *ccanr_good = NULL;		/* ccanr_good[1..num_good]: vars with diff > 0 */
+int *ccanr_good_pos = NULL;	/* and ccanr_conf set; indexed by var: position */
+int num_good;
+
+
+int
+ccanr_parse_parameters(PROTO(char *) inputline)
+     /* Parse "ccanr [G [R]]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    ccanr_gamma = 0;
+    ccanr_rho = CCANR_RHO_DEFAULT;
+    sscanf(inputline, " ccanr %d %f", &ccanr_gamma, &ccanr_rho);
+    if (ccanr_rho < 0.0 || ccanr_rho > 1.0){
+	crash_maybe(" Error: ccanr smoothing factor must be between 0 and 1\n");
+	ccanr_rho = CCANR_RHO_DEFAULT;
+    }
+    if (ccanr_gamma > 0)
+      printf(" option: ccanr, smooth at average weight %d, factor %f\n", ccanr_gamma, ccanr_rho);
+    else
+      printf(" option: ccanr, smooth at default average weight, factor %f\n", ccanr_rho);
+    ccanr_greedy = 0;
+    ccanr_aspirations = 0;
+    ccanr_increases = 0;
+    ccanr_smooths = 0;
+    return 1;
+}
+
+void
+ccanr_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_ccanr: %d\n", flag_ccanr);
+    fprintf(fp_report, "ccanr_gamma: %d\n", ccanr_gamma);
+    fprintf(fp_report, "ccanr_rho: %f\n", ccanr_rho);
+    fprintf(fp_report, "ccanr_greedy: %d\n", ccanr_greedy);
+    fprintf(fp_report, "ccanr_aspirations: %d\n", ccanr_aspirations);
+    fprintf(fp_report, "ccanr_increases: %d\n", ccanr_increases);
+    fprintf(fp_report, "ccanr_smooths: %d\n", ccanr_smooths);
+}
+
+static void
+ccanr_build_neighbors()
+     /* Fill ccanr_nbr from the occurrence chains, in two passes: the
+	first counts, the second stores */
+{
+    int *mark;
+    int pass, v, u, i, n, next_clause, clause_len;
+    wff_str_ptr clause_ptr;
+
+    mark = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    ccanr_nbr_start = (int *) malloc((size_t)((nvars + 2) * sizeof(int)));
+    if (mark == NULL || ccanr_nbr_start == NULL)
+      crash_and_burn("ERROR: cannot allocate ccanr neighbors\n");
+
+    for (pass = 0; pass < 2; pass++){
+	for (v = 0; v <= nvars; v++) mark[v] = 0;
+	n = 0;
+	for (v = 1; v <= nvars; v++){
+	    ccanr_nbr_start[v] = n;
+	    next_clause = assign[v].first;
+	    while (next_clause != -1){
+		clause_ptr = &wff[next_clause];
+		clause_len = clause_ptr->lit;
+		for (i = 1; i <= clause_len; i++){
+		    u = abs_val(clause_ptr[i].lit);
+		    if (u == v)
+		      next_clause = clause_ptr[i].next;
+		    else if (mark[u] != v){
+			mark[u] = v;
+			if (pass) ccanr_nbr[n] = u;
+			n++;
+		    }
+		}
+	    }
+	}
+	ccanr_nbr_start[nvars + 1] = n;
+	if (pass == 0){
+	    ccanr_nbr = (int *) malloc((size_t)((n + 1) * sizeof(int)));
+	    if (ccanr_nbr == NULL)
+	      crash_and_burn("ERROR: cannot allocate ccanr neighbors\n");
+	}
+    }
+    free((char *) mark);
+}
+
+static void
+ccanr_check(PROTO(int) v)
+     /* Put v on the candidate list or take it off, as its diff and
+	configuration require */
+PARAMS( int v; )
+{
+    if (assign[v].diff > 0 && ccanr_conf[v]){
+	if (!ccanr_good_pos[v])
+	  ccanr_good[ccanr_good_pos[v] = ++num_good] = v;
+    }
+    else if (ccanr_good_pos[v]){
+	ccanr_good_pos[ccanr_good[ccanr_good_pos[v]] = ccanr_good[num_good--]] = ccanr_good_pos[v];
+	ccanr_good_pos[v] = 0;
+    }
+}
+
+static void
+ccanr_allocate()
+     /* Find the neighbors and make the lists, on first use */
+{
+    int i;
+
+    ccanr_build_neighbors();
+    ccanr_conf = (char *) malloc((size_t)(nvars + 1));
+    ccanr_good = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    ccanr_good_pos = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    if (ccanr_conf == NULL || ccanr_good == NULL || ccanr_good_pos == NULL)
+      crash_and_burn("ERROR: cannot allocate ccanr lists\n");
+    for (i = 0; i <= nvars; i++) ccanr_good_pos[i] = 0;
+    num_good = 0;
+    if (ccanr_gamma <= 0)
+      ccanr_gamma = 200 + (nvars + 250) / 500;
+}
+
+void
+ccanr_initialize()
+     /* Called at the start of each try, after the weights are set and
+	init_diff has built the false clause list */
+{
+    int i, clause_index;
+
+    if (flag_coloring)
+      crash_and_burn("ERROR: ccanr cannot be used with the color option\n");
+    if (flag_hillclimb)
+      crash_and_burn("ERROR: ccanr cannot be used with the hillclimb option\n");
+
+    if (ccanr_nbr == NULL) ccanr_allocate();
+
+    num_good = 0;
+    for (i = 1; i <= nvars; i++){
+	ccanr_conf[i] = 1;
+	ccanr_good_pos[i] = 0;
+	ccanr_check(i);
+    }
+
+    /* Weights may carry over from the previous try */
+    ccanr_total_weight = 0;
+    clause_index = 1;
+    for (i = 1; i <= nclauses; i++){
+	ccanr_total_weight += wff[clause_index].next;
+	clause_index += wff[clause_index].lit + 1;
+    }
+}
+
+void
+ccanr_flipped(PROTO(int) var)
+     /* Called after var is flipped and update_diff is done */
+PARAMS( int var; )
+{
+    int i;
+
+    ccanr_conf[var] = 0;
+    ccanr_check(var);
+    for (i = ccanr_nbr_start[var]; i < ccanr_nbr_start[var + 1]; i++){
+	ccanr_conf[ccanr_nbr[i]] = 1;
+	ccanr_check(ccanr_nbr[i]);
+    }
+}
+
+static void
+ccanr_add_weight(PROTO(int) clause_index, PROTO(int) delta)
+     /* Add delta to the weight of a clause, updating the diffs and
+	makes of its vars */
+PARAMS( int clause_index; int delta; )
+{
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp, crit;
+    int j, clause_len, npos;
+
+    clause_ptr = &wff[clause_index];
+    clause_len = clause_ptr->lit;
+    clause_ptr->next += delta;
+    ccanr_total_weight += delta;
+
+    npos = 0;
+    crit = NULL;
+    for (j = 1; j <= clause_len; j++){
+	if (same_sign(assign[abs_val(clause_ptr[j].lit)].value, clause_ptr[j].lit)){
+	    npos++;
+	    crit = &assign[abs_val(clause_ptr[j].lit)];
+	}
+    }
+    if (npos == 0){
+	/* false: flipping any var makes delta more */
+	for (j = 1; j <= clause_len; j++){
+	    vp = &assign[abs_val(clause_ptr[j].lit)];
+	    vp->diff += delta;
+	    vp->make += delta;
+	    adjust_bucket(vp);
+	    ccanr_check(vp->name);
+	}
+    }
+    else if (npos == 1){
+	/* flipping the critical var breaks delta more */
+	crit->diff -= delta;
+	adjust_bucket(crit);
+	ccanr_check(crit->name);
+    }
+}
+
+static void
+ccanr_update_weights()
+     /* Add 1 to the weight of every false clause, and smooth if the
+	average weight is above ccanr_gamma */
+{
+    int i, clause_index, w, avg;
+
+    ccanr_increases++;
+    for (i = 1; i <= num_false_clauses; i++)
+      ccanr_add_weight(false_clause[i], 1);
+
+    if (ccanr_total_weight > ccanr_gamma * nclauses){
+	ccanr_smooths++;
+	avg = ccanr_total_weight / nclauses;
+	clause_index = 1;
+	for (i = 1; i <= nclauses; i++){
+	    w = (int)(ccanr_rho * wff[clause_index].next) + (int)((1.0 - ccanr_rho) * avg);
+	    if (w < 1) w = 1;
+	    if (w != wff[clause_index].next)
+	      ccanr_add_weight(clause_index, w - wff[clause_index].next);
+	    clause_index += wff[clause_index].lit + 1;
+	}
+    }
+}
+
+int
+ccanr_pick_var()
+     /* Pick the next var to flip; 0 if no clause is false */
+{
+    score_bucket_ptr sb;
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp, best;
+    int i, d, clause_len;
+
+    if (num_good > 0){
+	ccanr_greedy++;
+	best = &assign[ccanr_good[1]];
+	for (i = 2; i <= num_good; i++){
+	    vp = &assign[ccanr_good[i]];
+	    if (vp->diff > best->diff ||
+		(vp->diff == best->diff && vp->last_flip < best->last_flip))
+	      best = vp;
+	}
+	return best->name;
+    }
+
+    if (num_false_clauses == 0) return 0;
+
+    d = score_max();
+    if (d > 0 && d * nclauses > ccanr_total_weight){
+	ccanr_aspirations++;
+	sb = &score_bucket[d - score_low];
+	best = &assign[sb->vars[1]];
+	for (i = 2; i <= sb->len; i++){
+	    vp = &assign[sb->vars[i]];
+	    if (vp->last_flip < best->last_flip)
+	      best = vp;
+	}
+	return best->name;
+    }
+
+    ccanr_update_weights();
+    clause_ptr = &wff[false_clause[random_1_to(num_false_clauses)]];
+    clause_len = clause_ptr->lit;
+    best = &assign[abs_val(clause_ptr[1].lit)];
+    for (i = 2; i <= clause_len; i++){
+	vp = &assign[abs_val(clause_ptr[i].lit)];
+	if (vp->last_flip < best->last_flip)
+	  best = vp;
+    }
+    return best->name;
+}
+
+void
+ccanr_checkpoint()
+     /* The weights are in the wff; the rest is rebuilt each try */
+{
+    checkpoint_data((char *) &ccanr_gamma, (long) sizeof(int));
+    checkpoint_data((char *) &ccanr_greedy, (long) sizeof(int));
+    checkpoint_data((char *) &ccanr_aspirations, (long) sizeof(int));
+    checkpoint_data((char *) &ccanr_increases, (long) sizeof(int));
+    checkpoint_data((char *) &ccanr_smooths, (long) sizeof(int));
+}
+
+void
+ccanr_checkpoint_try()
+     /* The configurations and the list of good vars, in its order */
+{
+    if (ccanr_nbr == NULL) ccanr_allocate();
+    checkpoint_data(ccanr_conf, (long) (nvars + 1));
+    checkpoint_list(ccanr_good, ccanr_good_pos, &num_good);
+    checkpoint_data((char *) &ccanr_total_weight, (long) sizeof(int));
+}
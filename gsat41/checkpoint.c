@@ -0,0 +1,585 @@
+/* checkpoint.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Checkpoint and resume.  With "checkpoint FILE [SECS]" gsat writes
+   a snapshot of its state to FILE every SECS seconds (default 300), on
+   SIGUSR2 and SIGTERM, and at the end of the run.  The handlers (and
+   the SIGALRM timer) only set checkpoint_requested; the snapshot is
+   taken by checkpoint_service at the next flip or try.  With
+   "resume FILE" gsat reads the wff and options as usual, then loads
+   FILE and goes on from the flip or try where the snapshot was taken,
+   drawing the same random numbers, so that given the same wff and
+   options the rest of the run is the same as if it had never stopped
+   (apart from times).  A run ended at the end of its tries may be
+   resumed with a larger max_tries.
+
+   Between tries, a snapshot holds what the next try starts from: the
+   random number states (random(), drand48 and urand), the counters and
+   totals, the best, low and current assignments, the clause weights
+   held in the next fields of the clause headers of the wff, the bad
+   clause histograms, the state that other options carry from try to
+   try (through their *_checkpoint functions), and the try statistics
+   written so far.  Taken between the flips of a try (checkpoint_in_try
+   set), it also holds the work of the try: flip, low_bad and the
+   try's counts, each var's diff, make, last flip and places in the
+   up, down, sideways and walk lists and the score buckets, the
+   buckets themselves, the false clause list, and the state of the try
+   kept by other options (through their *_checkpoint_try functions).
+   Lists are saved in their order, since picks are made by position,
+   so a resumed try makes the same flips.  checkpoint_data moves each
+   field into the snapshot or, when resuming, out of the file, so the
+   same code lists the fields for both.  With the tempering option the
+   other replicas are other processes, so a snapshot asked for during
+   a try is put off until the try ends.
+
+   Writing does not stall the flips: a child process is forked to
+   write the snapshot to FILE.PID and rename it over FILE, so FILE is
+   always a whole checkpoint.  Only the writes on SIGTERM and at the
+   end are made by gsat itself.  The elite, coordinate, worker and rtd
+   options do not go with checkpoints; the stream, record and phases
+   files are started afresh. */
+
+#include "gsat.h"
+#include "checkpoint.h"
+#include "anneal.h"
+#include "paws.h"
+#include "novelty.h"
+#include "ccanr.h"
+#include "population.h"
+#include "tempering.h"
+#include "score.h"
+#include "pb.h"
+#include "utils.h"
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+
+EXTERN_FUNCTION( int fork, (void));
+EXTERN_FUNCTION( int getpid, (void));
+EXTERN_FUNCTION( int close, (int fd));
+EXTERN_FUNCTION( long write, (int fd, const void * buf, unsigned long n));
+EXTERN_FUNCTION( long pread, (int fd, void * buf, unsigned long n, off_t offset));
+EXTERN_FUNCTION( int fsync, (int fd));
+EXTERN_FUNCTION( void _exit, (int status));
+#ifndef SYSVR4
+EXTERN_FUNCTION( char * initstate, (unsigned seed, char * state, size_t n));
+EXTERN_FUNCTION( char * setstate, (char * state));
+#endif
+
+#define CHECKPOINT_MAGIC "GSATCKPT"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_SECS 300	/* default seconds between writes */
+#define CHECKPOINT_RANDOM_STATE 128	/* bytes of the default random() state */
+#define CHECKPOINT_COPY 65536	/* bytes of try statistics copied at a time */
+
+#define CHECKPOINT_SAVE 0
+#define CHECKPOINT_LOAD 1
+
+struct checkpoint_header_str {
+    char magic[8];		/* CHECKPOINT_MAGIC */
+    int version;		/* CHECKPOINT_VERSION */
+    int nvars, nclauses, nlits;
+    int options;		/* bits of the options that carry state */
+    int current_try;		/* tries done, or the try in progress */
+    int in_try;			/* 1 = taken between the flips of current_try */
+    long body;			/* bytes of snapshot */
+    long try_stats;		/* bytes of try statistics after it */
+};
+
+typedef struct checkpoint_buffer_str {
+    struct checkpoint_header_str header;
+    char * data;
+    long size, allocated;
+} *checkpoint_buffer_ptr;
+
+char checkpoint_file[MAXLINE];
+char resume_file[MAXLINE];
+int checkpoint_secs;
+int checkpoint_mode;		/* CHECKPOINT_SAVE or CHECKPOINT_LOAD */
+int checkpoint_in_try;		/* 1 while the flips of a try are made */
+struct checkpoint_buffer_str checkpoint_buffer;
+checkpoint_buffer_ptr checkpoint_building;	/* buffer being built, or loaded */
+long checkpoint_loaded;		/* bytes of a loaded snapshot used so far */
+int checkpoint_writer = -1;	/* pid of the process writing, if any */
+volatile sig_atomic_t checkpoint_requested;	/* 1 = fork a writer, 2 = write now */
+int checkpoint_writes;		/* checkpoints written */
+int checkpoint_resumed_try;	/* current_try when resumed, 0 = not resumed */
+int checkpoint_resumed_flip = -1;	/* flip when resumed inside a try */
+#ifndef SYSVR4
+char checkpoint_scratch[CHECKPOINT_RANDOM_STATE];
+#endif
+
+
+int
+checkpoint_parse_parameters(PROTO(char *) inputline)
+     /* Parse "checkpoint FILE [SECS]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    checkpoint_secs = CHECKPOINT_SECS;
+    if (sscanf(inputline, " checkpoint %s %d", checkpoint_file, &checkpoint_secs) < 1 ||
+	checkpoint_secs < 0){
+	crash_maybe(" Error: checkpoint needs a file name\n");
+	return 0;
+    }
+    printf(" option: checkpoint to %s every %d seconds\n", checkpoint_file, checkpoint_secs);
+    return 1;
+}
+
+int
+resume_parse_parameters(PROTO(char *) inputline)
+     /* Parse "resume FILE"; returns 1 */
+PARAMS( char * inputline; )
+{
+    if (sscanf(inputline, " resume %s", resume_file) != 1){
+	crash_maybe(" Error: resume needs a file name\n");
+	return 0;
+    }
+    printf(" option: resume from %s\n", resume_file);
+    return 1;
+}
+
+void
+checkpoint_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    if (flag_checkpoint){
+	fprintf(fp_report, "checkpoint_file: %s\n", checkpoint_file);
+	fprintf(fp_report, "checkpoint_secs: %d\n", checkpoint_secs);
+	fprintf(fp_report, "checkpoint_writes: %d\n", checkpoint_writes);
+    }
+    if (flag_resume){
+	fprintf(fp_report, "resume_file: %s\n", resume_file);
+	fprintf(fp_report, "resumed_try: %d\n", checkpoint_resumed_try);
+	fprintf(fp_report, "resumed_flip: %d\n", checkpoint_resumed_flip);
+    }
+}
+
+static void
+checkpoint_signal(PROTO(int) sig)
+     /* SIGUSR2, and SIGALRM every SECS seconds: ask for a checkpoint */
+PARAMS( int sig; )
+{
+    checkpoint_request(0);
+}
+
+void
+checkpoint_request(PROTO(int) now)
+     /* Called from a signal handler: write the latest snapshot at the
+	next flip or try, forking a writer, or with now (on SIGTERM)
+	without forking */
+PARAMS( int now; )
+{
+    if (now || checkpoint_requested == 0)
+      checkpoint_requested = now ? 2 : 1;
+    signals_pending = 1;
+}
+
+void
+checkpoint_start()
+     /* Check the options, catch SIGUSR2 and start the timer; called
+	once the wff is read */
+{
+    struct itimerval it;
+
+    if (flag_elite || flag_coordinate || flag_worker || flag_rtd)
+      crash_and_burn("ERROR: checkpoint and resume cannot be combined with elite, coordinate, worker or rtd\n");
+    if (!flag_checkpoint) return;
+    signal(SIGUSR2, checkpoint_signal);
+    if (checkpoint_secs > 0){
+	signal(SIGALRM, checkpoint_signal);
+	it.it_interval.tv_sec = it.it_value.tv_sec = checkpoint_secs;
+	it.it_interval.tv_usec = it.it_value.tv_usec = 0;
+	setitimer(ITIMER_REAL, &it, NULL);
+    }
+}
+
+void
+checkpoint_data(PROTO(char *) p, PROTO(long) n)
+     /* Move n bytes at p into the snapshot being built, or out of the
+	one being loaded */
+PARAMS( char * p; long n; )
+{
+    checkpoint_buffer_ptr b;
+
+    b = checkpoint_building;
+    if (checkpoint_mode == CHECKPOINT_LOAD){
+	if (checkpoint_loaded + n > b->size){
+	    sprintf(ss, "ERROR: checkpoint %s is too short\n", resume_file);
+	    crash_and_burn(ss);
+	}
+	memcpy(p, b->data + checkpoint_loaded, (size_t) n);
+	checkpoint_loaded += n;
+	return;
+    }
+    if (b->size + n > b->allocated){
+	b->allocated = 2 * (b->size + n);
+	b->data = (b->data == NULL) ? (char *) malloc((size_t) b->allocated)
+	  : (char *) realloc(b->data, (size_t) b->allocated);
+	if (b->data == NULL)
+	  crash_and_burn("ERROR: cannot allocate checkpoint\n");
+    }
+    memcpy(b->data + b->size, p, (size_t) n);
+    b->size += n;
+}
+
+#define checkpoint_int(X) checkpoint_data((char *) &(X), (long) sizeof(int))
+
+int
+checkpoint_loading()
+     /* 1 while a snapshot is being loaded */
+{
+    return checkpoint_mode == CHECKPOINT_LOAD;
+}
+
+void
+checkpoint_list(PROTO(int *) list, PROTO(int *) pos, PROTO(int *) n)
+     /* An indexed list list[1..*n] of items i with pos[i] their
+	position, and pos 0 for the items not in it */
+PARAMS( int * list; int * pos; int * n; )
+{
+    int i;
+
+    if (checkpoint_mode == CHECKPOINT_LOAD)
+      for (i = 1; i <= *n; i++) pos[list[i]] = 0;
+    checkpoint_int(*n);
+    checkpoint_data((char *) &list[1], (long) (*n * sizeof(int)));
+    if (checkpoint_mode == CHECKPOINT_LOAD)
+      for (i = 1; i <= *n; i++) pos[list[i]] = i;
+}
+
+static int
+checkpoint_options()
+     /* The options whose state is in a snapshot */
+{
+    return (flag_anneal != 0) | (flag_paws != 0) << 1 | (flag_novelty != 0) << 2 |
+      (flag_ccanr != 0) << 3 | (flag_population != 0) << 4 |
+      (flag_tempering != 0) << 5 | (rand_method == 1) << 6 | (flag_pb != 0) << 7;
+}
+
+static void
+checkpoint_random()
+     /* The random number states */
+{
+#ifdef SYSVR4
+    unsigned short state[3], *old;
+
+    if (checkpoint_mode == CHECKPOINT_SAVE){
+	old = seed48(state);
+	memcpy((char *) state, (char *) old, sizeof(state));
+	seed48(state);
+    }
+    checkpoint_data((char *) state, (long) sizeof(state));
+    if (checkpoint_mode == CHECKPOINT_LOAD) seed48(state);
+#else
+    char * old;
+
+    /* initstate hands back the state in use, with its position in it */
+    old = initstate(1, checkpoint_scratch, (size_t) CHECKPOINT_RANDOM_STATE);
+    checkpoint_data(old, (long) CHECKPOINT_RANDOM_STATE);
+    setstate(old);
+#endif
+    if (rand_method != 1) checkpoint_data((char *) rd, (long) sizeof(uniform));
+}
+
+static void
+checkpoint_try_fields()
+     /* The work of the try in progress, between two of its flips */
+{
+    int i;
+    var_str_ptr vp;
+
+    checkpoint_int(flip);
+    checkpoint_int(low_bad);
+    checkpoint_int(init_bad);
+    checkpoint_int(current_max_diff);
+    checkpoint_int(downwards_count);
+    checkpoint_int(sideways_count);
+    checkpoint_int(upwards_count);
+    checkpoint_int(null_count);
+    checkpoint_int(flips_to_plateau);
+    checkpoint_int(flag_hole);
+
+    /* assign[0] holds the lengths of the lists */
+    for (i = 0, vp = assign; i <= nvars; i++, vp++){
+	checkpoint_int(vp->diff);
+	checkpoint_int(vp->make);
+	checkpoint_int(vp->last_flip);
+	checkpoint_int(vp->score);
+	checkpoint_int(vp->score_pos);
+	checkpoint_data((char *) &vp->walk, (long) sizeof(indexed_list));
+	checkpoint_data((char *) &vp->up, (long) sizeof(indexed_list));
+	checkpoint_data((char *) &vp->down, (long) sizeof(indexed_list));
+	checkpoint_data((char *) &vp->sideways, (long) sizeof(indexed_list));
+    }
+    score_checkpoint();
+    checkpoint_list(false_clause, false_clause_pos, &num_false_clauses);
+
+    if (flag_anneal) anneal_checkpoint_try();
+    if (flag_paws) paws_checkpoint_try();
+    if (flag_novelty) novelty_checkpoint_try();
+    if (flag_ccanr) ccanr_checkpoint_try();
+    if (flag_pb) pb_checkpoint_try();
+}
+
+static void
+checkpoint_fields()
+     /* Everything a try leaves for the next, in the order of the file,
+	and the work of the try in progress if in one */
+{
+    int i, clause_index;
+    var_str_ptr vp;
+    wff_str_ptr wff_ptr;
+
+    checkpoint_int(current_try);
+    checkpoint_int(try_this_assign);
+    checkpoint_int(current_num_bad);
+    checkpoint_int(boost_on);
+    checkpoint_int(seed1);
+    checkpoint_int(seed2);
+    checkpoint_random();
+
+    checkpoint_int(best_num_bad);
+    checkpoint_int(best_flip);
+    checkpoint_int(best_try);
+    checkpoint_int(best_max_diff);
+    checkpoint_int(best_reset_count);
+    checkpoint_int(best_downwards);
+    checkpoint_int(best_sideways);
+    checkpoint_int(best_upwards);
+    checkpoint_int(best_null);
+    checkpoint_int(total_num_assigns);
+    checkpoint_int(total_sum_flips);
+    checkpoint_int(total_sum_tries);
+    checkpoint_int(total_downwards);
+    checkpoint_int(total_sideways);
+    checkpoint_int(total_upwards);
+    checkpoint_int(total_successful_flips_incl_resets);
+    checkpoint_int(total_successful_reset_count);
+    checkpoint_int(total_null);
+    checkpoint_int(total_after_init_num_bad);
+    checkpoint_int(total_sum_successful_flips);
+    checkpoint_data((char *) &experiment_seconds, (long) sizeof(double));
+
+    for (i = 1, vp = &assign[1]; i <= nvars; i++, vp++){
+	checkpoint_data((char *) &vp->value, (long) sizeof(truth_val_type));
+	checkpoint_data((char *) &vp->value_best, (long) sizeof(truth_val_type));
+	checkpoint_data((char *) &vp->value_low, (long) sizeof(truth_val_type));
+	checkpoint_data((char *) &vp->prev_low, (long) sizeof(truth_val_type));
+	checkpoint_data((char *) &vp->first_init_value, (long) sizeof(truth_val_type));
+	checkpoint_int(vp->positive_count);
+	checkpoint_int(vp->flip_count);
+    }
+    for (i = 1, clause_index = 1; i <= nclauses; i++){
+	wff_ptr = &wff[clause_index];
+	checkpoint_int(wff_ptr->next);
+	clause_index += wff_ptr->lit + 1;
+    }
+    checkpoint_data((char *) bad_clause_count,
+		    (long) ((LENGTH_BAD_CLAUSE_COUNT + 1) * sizeof(struct bad_clause_count_str)));
+    checkpoint_data((char *) reset_bad_clause_count,
+		    (long) ((LENGTH_BAD_CLAUSE_COUNT + 1) * sizeof(struct bad_clause_count_str)));
+
+    if (flag_anneal) anneal_checkpoint();
+    if (flag_paws) paws_checkpoint();
+    if (flag_novelty) novelty_checkpoint();
+    if (flag_ccanr) ccanr_checkpoint();
+    if (flag_population) population_checkpoint();
+    if (flag_tempering) tempering_checkpoint();
+    if (flag_pb) pb_checkpoint();
+
+    if (checkpoint_in_try) checkpoint_try_fields();
+}
+
+static int
+checkpoint_write(PROTO(checkpoint_buffer_ptr) b)
+     /* Write b to FILE.PID and rename it to FILE; returns 1 if done */
+PARAMS( checkpoint_buffer_ptr b; )
+{
+    char temp[MAXLINE + 32], copy[CHECKPOINT_COPY];
+    int fd;
+    long done, n;
+
+    sprintf(temp, "%s.%d", checkpoint_file, getpid());
+    if ((fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) return 0;
+    if (write(fd, (char *) &b->header, (unsigned long) sizeof(b->header)) != sizeof(b->header) ||
+	write(fd, b->data, (unsigned long) b->size) != b->size){
+	close(fd);
+	return 0;
+    }
+    for (done = 0; done < b->header.try_stats; done += n){
+	n = b->header.try_stats - done;
+	if (n > CHECKPOINT_COPY) n = CHECKPOINT_COPY;
+	if (pread(fileno(try_stat_filep), copy, (unsigned long) n, (off_t) done) != n ||
+	    write(fd, copy, (unsigned long) n) != n){
+	    close(fd);
+	    return 0;
+	}
+    }
+    if (fsync(fd) != 0 || close(fd) != 0) return 0;
+    return rename(temp, checkpoint_file) == 0;
+}
+
+static void
+checkpoint_snapshot()
+     /* Take a snapshot of the state now, between flips or tries */
+{
+    checkpoint_buffer_ptr b;
+
+    b = &checkpoint_buffer;
+    b->size = 0;
+    checkpoint_building = b;
+    checkpoint_mode = CHECKPOINT_SAVE;
+    checkpoint_fields();
+
+    fflush(try_stat_filep);
+    memcpy(b->header.magic, CHECKPOINT_MAGIC, sizeof(b->header.magic));
+    b->header.version = CHECKPOINT_VERSION;
+    b->header.nvars = nvars;
+    b->header.nclauses = nclauses;
+    b->header.nlits = nlits;
+    b->header.options = checkpoint_options();
+    b->header.current_try = current_try;
+    b->header.in_try = checkpoint_in_try;
+    b->header.body = b->size;
+    b->header.try_stats = ftell(try_stat_filep);
+}
+
+static void
+checkpoint_fork()
+     /* Fork a process to write a snapshot, unless one is still writing */
+{
+    int pid;
+
+    if (checkpoint_writer > 0 && waitpid(checkpoint_writer, NULL, WNOHANG) == checkpoint_writer)
+      checkpoint_writer = -1;
+    if (checkpoint_writer > 0) return;
+    checkpoint_snapshot();
+    pid = fork();
+    if (pid == 0)
+      _exit(checkpoint_write(&checkpoint_buffer) ? 0 : 1);
+    if (pid > 0){
+	checkpoint_writer = pid;
+	checkpoint_writes++;
+    }
+}
+
+void
+checkpoint_now()
+     /* Take a snapshot and write it without forking, e.g. on SIGTERM */
+{
+    if (checkpoint_writer > 0){
+	waitpid(checkpoint_writer, NULL, 0);
+	checkpoint_writer = -1;
+    }
+    checkpoint_snapshot();
+    if (checkpoint_write(&checkpoint_buffer))
+      checkpoint_writes++;
+    else
+      fprintf(stderr, "gsat: cannot write checkpoint %s\n", checkpoint_file);
+}
+
+void
+checkpoint_service()
+     /* Between flips or tries: make the write a signal asked for */
+{
+    int now;
+
+    if (checkpoint_requested == 0) return;
+    /* the other replicas' tries cannot be saved from here */
+    if (flag_tempering && checkpoint_in_try) return;
+    now = (checkpoint_requested == 2);
+    checkpoint_requested = 0;
+    if (now)
+      checkpoint_now();
+    else
+      checkpoint_fork();
+}
+
+void
+checkpoint_try()
+     /* Before a try: make a write put off until the last one ended */
+{
+    checkpoint_service();
+}
+
+void
+checkpoint_resume()
+     /* Load the resume file; called in place of starting at try 0 */
+{
+    struct checkpoint_buffer_str b;
+    FILE * fp;
+    char copy[CHECKPOINT_COPY];
+    long done, n;
+
+    if ((fp = fopen(resume_file, "r")) == NULL){
+	sprintf(ss, "ERROR: cannot open checkpoint %s\n", resume_file);
+	crash_and_burn(ss);
+    }
+    if (fread((char *) &b.header, sizeof(b.header), 1, fp) != 1 ||
+	strncmp(b.header.magic, CHECKPOINT_MAGIC, sizeof(b.header.magic)) != 0 ||
+	b.header.version != CHECKPOINT_VERSION){
+	sprintf(ss, "ERROR: %s is not a gsat checkpoint\n", resume_file);
+	crash_and_burn(ss);
+    }
+    if (b.header.nvars != nvars || b.header.nclauses != nclauses || b.header.nlits != nlits){
+	sprintf(ss, "ERROR: checkpoint %s is of another wff\n", resume_file);
+	crash_and_burn(ss);
+    }
+    if (b.header.options != checkpoint_options()){
+	sprintf(ss, "ERROR: checkpoint %s was made with other options\n", resume_file);
+	crash_and_burn(ss);
+    }
+    b.size = b.allocated = b.header.body;
+    if ((b.data = (char *) malloc((size_t) b.size + 1)) == NULL ||
+	fread(b.data, 1, (size_t) b.size, fp) != (size_t) b.size){
+	sprintf(ss, "ERROR: checkpoint %s is too short\n", resume_file);
+	crash_and_burn(ss);
+    }
+    checkpoint_building = &b;
+    checkpoint_mode = CHECKPOINT_LOAD;
+    checkpoint_loaded = 0;
+    checkpoint_in_try = b.header.in_try;
+    checkpoint_fields();
+    checkpoint_mode = CHECKPOINT_SAVE;
+    if (checkpoint_loaded != b.size){
+	sprintf(ss, "ERROR: checkpoint %s does not match the options\n", resume_file);
+	crash_and_burn(ss);
+    }
+    free(b.data);
+
+    for (done = 0; done < b.header.try_stats; done += n){
+	n = b.header.try_stats - done;
+	if (n > CHECKPOINT_COPY) n = CHECKPOINT_COPY;
+	if ((long) fread(copy, 1, (size_t) n, fp) != n){
+	    sprintf(ss, "ERROR: checkpoint %s is too short\n", resume_file);
+	    crash_and_burn(ss);
+	}
+	fwrite(copy, 1, (size_t) n, try_stat_filep);
+    }
+    fclose(fp);
+    checkpoint_resumed_try = current_try;
+    checkpoint_resumed_flip = checkpoint_in_try ? flip : -1;
+    if (checkpoint_in_try)
+      printf("Resumed from %s in try %d after flip %d\n", resume_file, current_try, flip);
+    else
+      printf("Resumed from %s after try %d\n", resume_file, current_try);
+}
+
+void
+checkpoint_finish()
+     /* Write the state at the end of the run */
+{
+    checkpoint_now();
+    printf("checkpoint: %s after try %d\n", checkpoint_file, current_try);
+}
@@ -0,0 +1,35 @@
+/* checkpoint.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#include "proto.h"
+
+extern
+int checkpoint_in_try;		/* 1 while the flips of a try are made */
+
+EXTERN_FUNCTION( int checkpoint_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( int resume_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void checkpoint_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void checkpoint_start, ());
+EXTERN_FUNCTION( void checkpoint_data, (char * p, long n));
+EXTERN_FUNCTION( int checkpoint_loading, ());
+EXTERN_FUNCTION( void checkpoint_list, (int * list, int * pos, int * n));
+EXTERN_FUNCTION( void checkpoint_try, ());
+EXTERN_FUNCTION( void checkpoint_request, (int now));
+EXTERN_FUNCTION( void checkpoint_service, ());
+EXTERN_FUNCTION( void checkpoint_now, ());
+EXTERN_FUNCTION( void checkpoint_resume, ());
+EXTERN_FUNCTION( void checkpoint_finish, ());
+
+#endif
@@ -0,0 +1,604 @@
+/* cluster.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Cooperative solving by gsat processes over sockets, on one machine
+   or several.  A coordinator, started with "coordinate ADDRESS N
+   [FILE]", reads the wff and waits for N workers; a worker is an
+   ordinary gsat whose last option is "worker ADDRESS [SECS]".  ADDRESS
+   is HOST:PORT or PORT for TCP, or a path containing '/' for a Unix
+   socket.
+
+   When a worker connects, the coordinator sends it the option lines
+   of its profile, the paragraphs of FILE being dealt out in turn, then
+   "seed S" with S drawn from the coordinator's own seed, then a blank
+   line.  The worker parses them as if typed after the worker option,
+   reads the wff itself, and says hello with nvars and nclauses, which
+   must match the coordinator's.  Every SECS seconds (default 1) a
+   SIGALRM sends a heartbeat with the worker's best num_bad and its
+   totals so far.  A worker that finishes sends its final totals and
+   its best assignment, in input var names.  When one has satisfied the
+   wff the coordinator sends every other worker a stop byte; the next
+   heartbeat sees it, and at the next flip the worker sends the final
+   message and exits.
+
+   Integers travel in network byte order, so machines may differ.  The
+   coordinator's report adds up the workers' totals, and its
+   assignment file holds the best assignment any of them sent. */
+
+#include "gsat.h"
+#include "cluster.h"
+#include "reorder.h"
+#include "utils.h"
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+
+EXTERN_FUNCTION( int close, (int fd));
+EXTERN_FUNCTION( long read, (int fd, void * buf, unsigned long n));
+EXTERN_FUNCTION( long write, (int fd, const void * buf, unsigned long n));
+EXTERN_FUNCTION( unsigned sleep, (unsigned seconds));
+EXTERN_FUNCTION( int unlink, (const char * path));
+EXTERN_FUNCTION( void _exit, (int status));
+
+#define CLUSTER_MAX_WORKERS 256
+#define CLUSTER_MAX_PROFILES 64
+#define CLUSTER_CONNECT_TRIES 30	/* seconds a worker waits for the coordinator */
+#define CLUSTER_STOP 'S'		/* coordinator to worker: stop */
+
+/* Messages from a worker are CLUSTER_FIELDS integers; a FINAL one is
+   followed by nvars bytes, 1 for each true var */
+#define CLUSTER_HELLO 1
+#define CLUSTER_BEAT 2
+#define CLUSTER_FINAL 3
+
+#define CF_KIND 0
+#define CF_NVARS 1
+#define CF_NCLAUSES 2
+#define CF_BEST 3		/* best_num_bad */
+#define CF_NOW 4		/* current_num_bad */
+#define CF_TRIES 5
+#define CF_FLIPS 6		/* in a heartbeat, counts the current try too */
+#define CF_DOWN 7
+#define CF_UP 8
+#define CF_SIDE 9
+#define CF_NULL 10
+#define CF_ASSIGNS 11
+#define CF_SUCC_FLIPS 12
+#define CF_INIT_BAD 13
+#define CF_INCL_RESETS 14
+#define CF_RESET_COUNT 15
+#define CLUSTER_FIELDS 16
+
+char cluster_address[MAXLINE];
+char cluster_profile_file[MAXLINE];	/* empty = workers keep their own options */
+int cluster_workers;		/* workers the coordinator waits for */
+int cluster_beat_secs;		/* seconds between heartbeats */
+int cluster_fd = -1;		/* worker: socket to the coordinator */
+char *cluster_values = NULL;	/* worker: final message body */
+volatile sig_atomic_t cluster_stopping;	/* worker: 1 = the coordinator sent a stop */
+
+int cluster_num_profiles;
+char *cluster_profile[CLUSTER_MAX_PROFILES];	/* option lines, each ending in newline */
+int cluster_wfd[CLUSTER_MAX_WORKERS];	/* coordinator: socket of each worker, -1 when done */
+int cluster_stats[CLUSTER_MAX_WORKERS][CLUSTER_FIELDS];	/* last message of each worker */
+int cluster_model_worker;	/* worker whose assignment was kept; -1 = none */
+int cluster_beats;		/* heartbeats received */
+
+
+int
+cluster_coordinate_parse(PROTO(char *) inputline)
+     /* Parse "coordinate ADDRESS N [FILE]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    cluster_profile_file[0] = 0;
+    if (sscanf(inputline, " coordinate %s %d %s", cluster_address, &cluster_workers,
+	       cluster_profile_file) < 2 ||
+	cluster_workers < 1 || cluster_workers > CLUSTER_MAX_WORKERS){
+	sprintf(ss, " Error: coordinate needs an address and 1 to %d workers\n",
+		CLUSTER_MAX_WORKERS);
+	crash_maybe(ss);
+	return 0;
+    }
+    printf(" option: coordinate %d workers at %s", cluster_workers, cluster_address);
+    if (cluster_profile_file[0])
+      printf(", profiles from %s", cluster_profile_file);
+    printf("\n");
+    return 1;
+}
+
+static void
+cluster_read(PROTO(int) fd, PROTO(char *) buf, PROTO(int) n)
+     /* Read exactly n bytes; a worker that has lost the coordinator exits */
+PARAMS( int fd; char * buf; int n; )
+{
+    long got;
+
+    while (n > 0){
+	got = read(fd, buf, (unsigned long) n);
+	if (got <= 0){
+	    if (flag_worker) _exit(1);
+	    crash_and_burn("ERROR: cluster worker lost its socket\n");
+	}
+	buf += got;
+	n -= got;
+    }
+}
+
+static int
+cluster_write(PROTO(int) fd, PROTO(char *) buf, PROTO(int) n)
+     /* Write exactly n bytes; returns 0 if the other end has gone */
+PARAMS( int fd; char * buf; int n; )
+{
+    long put;
+
+    while (n > 0){
+	put = write(fd, buf, (unsigned long) n);
+	if (put <= 0) return 0;
+	buf += put;
+	n -= put;
+    }
+    return 1;
+}
+
+void
+cluster_unlink_socket(PROTO(char *) path)
+     /* Remove path if it is a socket, as left by an earlier run; any
+	other file is left alone */
+PARAMS( char * path; )
+{
+    struct stat st;
+
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+}
+
+int
+cluster_socket(PROTO(char *) address, PROTO(int) listening, PROTO(int) backlog)
+     /* Open a socket for address (PORT, HOST:PORT, or a path containing
+	'/'): connected with CLUSTER_CONNECT, or bound and listening with
+	room for backlog connections; a bare PORT listens on every
+	interface with CLUSTER_LISTEN, on the loopback interface with
+	CLUSTER_LISTEN_LOCAL.  -1 on failure */
+PARAMS( char * address; int listening; int backlog; )
+{
+    struct sockaddr_un un;
+    struct sockaddr_in in;
+    struct hostent *host;
+    struct sockaddr *sa;
+    char hostname_buf[MAXLINE], *colon;
+    int fd, len, port, one;
+
+    if (strchr(address, '/') != NULL){
+	if (strlen(address) >= sizeof(un.sun_path)){
+	    sprintf(ss, "ERROR: socket path %s is longer than %d bytes\n",
+		    address, (int) sizeof(un.sun_path) - 1);
+	    crash_and_burn(ss);
+	}
+	memset((char *) &un, 0, sizeof(un));
+	un.sun_family = AF_UNIX;
+	memcpy(un.sun_path, address, strlen(address) + 1);
+	if (listening != CLUSTER_CONNECT) cluster_unlink_socket(address);
+	sa = (struct sockaddr *) &un;
+	len = sizeof(un);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    }
+    else {
+	memset((char *) &in, 0, sizeof(in));
+	in.sin_family = AF_INET;
+	strcpy(hostname_buf, "localhost");
+	if ((colon = strrchr(address, ':')) != NULL){
+	    strncpy(hostname_buf, address, colon - address);
+	    hostname_buf[colon - address] = 0;
+	    port = atoi(colon + 1);
+	}
+	else
+	  port = atoi(address);
+	in.sin_port = htons((unsigned short) port);
+	if (listening == CLUSTER_LISTEN && colon == NULL)
+	  in.sin_addr.s_addr = htonl(INADDR_ANY);
+	else {
+	    if ((host = gethostbyname(hostname_buf)) == NULL) return -1;
+	    memcpy((char *) &in.sin_addr, host->h_addr, sizeof(in.sin_addr));
+	}
+	sa = (struct sockaddr *) &in;
+	len = sizeof(in);
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	one = 1;
+	if (fd >= 0 && listening != CLUSTER_CONNECT)
+	  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char *) &one, sizeof(one));
+    }
+    if (fd < 0) return -1;
+
+    if (listening != CLUSTER_CONNECT){
+	if (bind(fd, sa, len) != 0 || listen(fd, backlog) != 0){
+	    close(fd);
+	    return -1;
+	}
+    }
+    else if (connect(fd, sa, len) != 0){
+	close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+int
+cluster_worker_parse(PROTO(char *) inputline)
+     /* Parse "worker ADDRESS [SECS]" and connect; the rest of the options
+	then come from the coordinator.  Returns 1. */
+PARAMS( char * inputline; )
+{
+    int i;
+
+    cluster_beat_secs = 1;
+    if (sscanf(inputline, " worker %s %d", cluster_address, &cluster_beat_secs) < 1 ||
+	cluster_beat_secs < 1){
+	crash_maybe(" Error: worker needs an address and a positive heartbeat\n");
+	return 0;
+    }
+    for (i = 0; i < CLUSTER_CONNECT_TRIES; i++){
+	if ((cluster_fd = cluster_socket(cluster_address, CLUSTER_CONNECT, 0)) >= 0) break;
+	sleep(1);
+    }
+    if (cluster_fd < 0){
+	sprintf(ss, "ERROR: cannot connect to coordinator at %s\n", cluster_address);
+	crash_and_burn(ss);
+    }
+    printf(" option: worker for %s, heartbeat every %d s\n", cluster_address, cluster_beat_secs);
+    return 1;
+}
+
+int
+cluster_get_line(PROTO(char *) inputline)
+     /* Read an option line from the coordinator; 0 at end of file */
+PARAMS( char * inputline; )
+{
+    int n;
+    long got;
+
+    for (n = 0; n < MAXLINE - 1; n++){
+	got = read(cluster_fd, &inputline[n], 1L);
+	if (got <= 0){
+	    if (n == 0) return 0;
+	    break;
+	}
+	if (inputline[n] == '\n') break;
+    }
+    inputline[n] = 0;
+    printf("%s\n", inputline);
+    return 1;
+}
+
+static void
+cluster_fill(PROTO(int *) msg, PROTO(int) kind)
+     /* Fill a message with this worker's state */
+PARAMS( int * msg; int kind; )
+{
+    int i;
+
+    msg[CF_KIND] = kind;
+    msg[CF_NVARS] = nvars;
+    msg[CF_NCLAUSES] = nclauses;
+    msg[CF_BEST] = best_num_bad;
+    msg[CF_NOW] = current_num_bad;
+    msg[CF_TRIES] = total_sum_tries;
+    msg[CF_FLIPS] = total_sum_flips + (kind == CLUSTER_BEAT ? flip : 0);
+    msg[CF_DOWN] = total_downwards;
+    msg[CF_UP] = total_upwards;
+    msg[CF_SIDE] = total_sideways;
+    msg[CF_NULL] = total_null;
+    msg[CF_ASSIGNS] = total_num_assigns;
+    msg[CF_SUCC_FLIPS] = total_sum_successful_flips;
+    msg[CF_INIT_BAD] = total_after_init_num_bad;
+    msg[CF_INCL_RESETS] = total_successful_flips_incl_resets;
+    msg[CF_RESET_COUNT] = total_successful_reset_count;
+    for (i = 0; i < CLUSTER_FIELDS; i++)
+      msg[i] = htonl(msg[i]);
+}
+
+static void
+cluster_send_final()
+     /* Send the final totals and the best assignment */
+{
+    int msg[CLUSTER_FIELDS], i;
+
+    cluster_fill(msg, CLUSTER_FINAL);
+    for (i = 1; i <= nvars; i++)
+      cluster_values[external_var(i)] = (assign[i].value_best > 0);
+    if (cluster_write(cluster_fd, (char *) msg, sizeof(msg)))
+      cluster_write(cluster_fd, &cluster_values[1], nvars);
+}
+
+static void
+cluster_beat(PROTO(int) sig)
+     /* SIGALRM: send a heartbeat, and stop if the coordinator says so */
+PARAMS( int sig; )
+{
+    int msg[CLUSTER_FIELDS];
+    char c;
+    long got;
+
+    if (cluster_stopping) return;
+    got = recv(cluster_fd, &c, 1, MSG_DONTWAIT);
+    if (got == 0) _exit(1);		/* coordinator has gone */
+    if (got == 1 && c == CLUSTER_STOP){
+	/* the best assignment may be half saved; stop between flips */
+	cluster_stopping = 1;
+	signals_pending = 1;
+	return;
+    }
+    cluster_fill(msg, CLUSTER_BEAT);
+    if (!cluster_write(cluster_fd, (char *) msg, sizeof(msg)))
+      _exit(1);
+}
+
+void
+cluster_worker_start()
+     /* Say hello and start the heartbeats; called once the wff is read */
+{
+    int msg[CLUSTER_FIELDS];
+    struct itimerval it;
+
+    cluster_values = (char *) malloc((size_t)(nvars + 1));
+    if (cluster_values == NULL)
+      crash_and_burn("ERROR: cannot allocate cluster message\n");
+    cluster_fill(msg, CLUSTER_HELLO);
+    if (!cluster_write(cluster_fd, (char *) msg, sizeof(msg)))
+      crash_and_burn("ERROR: cluster worker lost its socket\n");
+
+    signal(SIGALRM, cluster_beat);
+    it.it_interval.tv_sec = cluster_beat_secs;
+    it.it_interval.tv_usec = 0;
+    it.it_value = it.it_interval;
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+void
+cluster_service()
+     /* Between flips: stop if the coordinator said so */
+{
+    if (cluster_stopping){
+	cluster_worker_finish();
+	_exit(0);
+    }
+}
+
+void
+cluster_worker_finish()
+     /* Stop the heartbeats and send the final message */
+{
+    struct itimerval it;
+
+    memset((char *) &it, 0, sizeof(it));
+    setitimer(ITIMER_REAL, &it, NULL);
+    signal(SIGALRM, SIG_IGN);
+    cluster_send_final();
+    close(cluster_fd);
+}
+
+static void
+cluster_read_profiles()
+     /* Split the profile file into paragraphs */
+{
+    FILE *fp;
+    char line[MAXLINE];
+    int in_profile, len;
+
+    cluster_num_profiles = 0;
+    if (cluster_profile_file[0] == 0) return;
+    if ((fp = fopen(cluster_profile_file, "r")) == NULL){
+	sprintf(ss, "ERROR: cannot open profile file %s\n", cluster_profile_file);
+	crash_and_burn(ss);
+    }
+    in_profile = 0;
+    while (fgets(line, MAXLINE, fp) != NULL){
+	if (empty_string(line)){
+	    in_profile = 0;
+	    continue;
+	}
+	if (!in_profile){
+	    if (cluster_num_profiles == CLUSTER_MAX_PROFILES)
+	      crash_and_burn("ERROR: too many cluster profiles\n");
+	    cluster_profile[cluster_num_profiles] = (char *) malloc(1);
+	    cluster_profile[cluster_num_profiles++][0] = 0;
+	    in_profile = 1;
+	}
+	len = strlen(cluster_profile[cluster_num_profiles - 1]);
+	cluster_profile[cluster_num_profiles - 1] = (char *)
+	  realloc(cluster_profile[cluster_num_profiles - 1], (size_t)(len + strlen(line) + 2));
+	strcat(cluster_profile[cluster_num_profiles - 1], line);
+	if (line[strlen(line) - 1] != '\n')
+	  strcat(cluster_profile[cluster_num_profiles - 1], "\n");
+    }
+    fclose(fp);
+    printf("cluster: %d profiles read from %s\n", cluster_num_profiles, cluster_profile_file);
+}
+
+static void
+cluster_stop_all()
+     /* Tell every worker still running to stop */
+{
+    int w;
+    char c;
+
+    c = CLUSTER_STOP;
+    for (w = 0; w < cluster_workers; w++)
+      if (cluster_wfd[w] >= 0)
+	cluster_write(cluster_wfd[w], &c, 1);
+}
+
+static void
+cluster_final(PROTO(int) w, PROTO(char *) values)
+     /* Keep worker w's assignment if it is the best so far */
+PARAMS( int w; char * values; )
+{
+    int i;
+
+    if (cluster_stats[w][CF_BEST] >= best_num_bad) return;
+    for (i = 1; i <= nvars; i++)
+      assign[internal_var(i)].value = values[i] ? 1 : -1;
+    current_num_bad = get_bad_clauses(0, 0);
+    if (current_num_bad != cluster_stats[w][CF_BEST]){
+	sprintf(ss, "ERROR: cluster worker %d claims %d bad clauses, but has %d\n",
+		w, cluster_stats[w][CF_BEST], current_num_bad);
+	crash_maybe(ss);
+    }
+    if (current_num_bad < best_num_bad){
+	save_current_as_best();
+	cluster_model_worker = w;
+    }
+}
+
+void
+cluster_coordinate()
+     /* Run the coordinator: deal out profiles, then gather heartbeats
+	and final messages until every worker is done */
+{
+    int listen_fd, w, i, running, maxfd, seed, best;
+    int msg[CLUSTER_FIELDS];
+    char line[MAXLINE], *values;
+    fd_set fds;
+    struct timeval start, now;
+
+    signal(SIGPIPE, SIG_IGN);
+    cluster_read_profiles();
+    if ((listen_fd = cluster_socket(cluster_address, CLUSTER_LISTEN, cluster_workers)) < 0){
+	sprintf(ss, "ERROR: cannot listen at %s\n", cluster_address);
+	crash_and_burn(ss);
+    }
+    values = (char *) malloc((size_t)(nvars + 1));
+    if (values == NULL)
+      crash_and_burn("ERROR: cannot allocate cluster message\n");
+
+    printf("cluster: waiting for %d workers at %s\n", cluster_workers, cluster_address);
+    for (w = 0; w < cluster_workers; w++){
+	fflush(stdout);
+	if ((cluster_wfd[w] = accept(listen_fd, NULL, NULL)) < 0)
+	  crash_and_burn("ERROR: cluster accept failed\n");
+	seed = random_1_to(INT_PROB_BASE);
+	if (cluster_num_profiles)
+	  cluster_write(cluster_wfd[w], cluster_profile[w % cluster_num_profiles],
+			strlen(cluster_profile[w % cluster_num_profiles]));
+	sprintf(line, "seed %d\n\n", seed);
+	cluster_write(cluster_wfd[w], line, strlen(line));
+	for (i = 0; i < CLUSTER_FIELDS; i++) cluster_stats[w][i] = 0;
+	cluster_stats[w][CF_BEST] = BIG;
+	printf("cluster: worker %d connected, profile %d, seed %d\n", w,
+	       cluster_num_profiles ? w % cluster_num_profiles : 0, seed);
+    }
+    close(listen_fd);
+    if (strchr(cluster_address, '/') != NULL) cluster_unlink_socket(cluster_address);
+
+    gettimeofday(&start, NULL);
+    cluster_model_worker = -1;
+    cluster_beats = 0;
+    best = BIG;
+    running = cluster_workers;
+    while (running > 0){
+	FD_ZERO(&fds);
+	maxfd = -1;
+	for (w = 0; w < cluster_workers; w++){
+	    if (cluster_wfd[w] < 0) continue;
+	    FD_SET(cluster_wfd[w], &fds);
+	    if (cluster_wfd[w] > maxfd) maxfd = cluster_wfd[w];
+	}
+	fflush(stdout);		/* stdout is buffered unless interactive */
+	if (signals_pending) service_signals();
+	if (select(maxfd + 1, &fds, NULL, NULL, NULL) < 0) continue;
+
+	for (w = 0; w < cluster_workers; w++){
+	    if (cluster_wfd[w] < 0 || !FD_ISSET(cluster_wfd[w], &fds)) continue;
+	    if (read(cluster_wfd[w], (char *) msg, 1L) != 1){
+		printf("cluster: worker %d hung up\n", w);
+		close(cluster_wfd[w]);
+		cluster_wfd[w] = -1;
+		running--;
+		continue;
+	    }
+	    cluster_read(cluster_wfd[w], ((char *) msg) + 1, sizeof(msg) - 1);
+	    for (i = 0; i < CLUSTER_FIELDS; i++)
+	      msg[i] = ntohl(msg[i]);
+
+	    if (msg[CF_NVARS] != nvars || msg[CF_NCLAUSES] != nclauses){
+		sprintf(ss, "ERROR: cluster worker %d has %d vars and %d clauses\n",
+			w, msg[CF_NVARS], msg[CF_NCLAUSES]);
+		crash_maybe(ss);
+		close(cluster_wfd[w]);
+		cluster_wfd[w] = -1;
+		running--;
+		continue;
+	    }
+	    if (msg[CF_KIND] == CLUSTER_HELLO) continue;
+	    for (i = 0; i < CLUSTER_FIELDS; i++)
+	      cluster_stats[w][i] = msg[i];
+	    if (msg[CF_KIND] == CLUSTER_BEAT) cluster_beats++;
+	    if (msg[CF_BEST] < best){
+		best = msg[CF_BEST];
+		printf("cluster: worker %d best %d after %d tries, %d flips\n",
+		       w, best, msg[CF_TRIES], msg[CF_FLIPS]);
+	    }
+	    if (msg[CF_KIND] == CLUSTER_FINAL){
+		cluster_read(cluster_wfd[w], &values[1], nvars);
+		close(cluster_wfd[w]);
+		cluster_wfd[w] = -1;
+		running--;
+		cluster_final(w, values);
+		if (msg[CF_BEST] == 0) cluster_stop_all();
+	    }
+	}
+    }
+    free(values);
+    gettimeofday(&now, NULL);
+    experiment_seconds += (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1e6;
+
+    /* The report shows the sum over the workers, and the
+       coordinator's wall clock time */
+    for (w = 0; w < cluster_workers; w++){
+	total_sum_tries += cluster_stats[w][CF_TRIES];
+	total_sum_flips += cluster_stats[w][CF_FLIPS];
+	total_downwards += cluster_stats[w][CF_DOWN];
+	total_upwards += cluster_stats[w][CF_UP];
+	total_sideways += cluster_stats[w][CF_SIDE];
+	total_null += cluster_stats[w][CF_NULL];
+	total_num_assigns += cluster_stats[w][CF_ASSIGNS];
+	total_sum_successful_flips += cluster_stats[w][CF_SUCC_FLIPS];
+	total_after_init_num_bad += cluster_stats[w][CF_INIT_BAD];
+	total_successful_flips_incl_resets += cluster_stats[w][CF_INCL_RESETS];
+	total_successful_reset_count += cluster_stats[w][CF_RESET_COUNT];
+    }
+}
+
+void
+cluster_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    int w;
+
+    if (flag_worker){
+	fprintf(fp_report, "cluster_worker_of: %s\n", cluster_address);
+	return;
+    }
+    fprintf(fp_report, "cluster_address: %s\n", cluster_address);
+    fprintf(fp_report, "cluster_workers: %d\n", cluster_workers);
+    fprintf(fp_report, "cluster_profiles: %d\n", cluster_num_profiles);
+    fprintf(fp_report, "cluster_heartbeats: %d\n", cluster_beats);
+    fprintf(fp_report, "cluster_model_worker: %d\n", cluster_model_worker);
+    fprintf(fp_report, "    worker  best_bad     tries       flips\n");
+    for (w = 0; w < cluster_workers; w++)
+      fprintf(fp_report, "  %8d  %8d  %8d  %10d\n", w, cluster_stats[w][CF_BEST],
+	      cluster_stats[w][CF_TRIES], cluster_stats[w][CF_FLIPS]);
+}
@@ -0,0 +1,34 @@
+/* cluster.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+#include "proto.h"
+
+/* How cluster_socket opens its socket */
+#define CLUSTER_CONNECT 0
+#define CLUSTER_LISTEN 1
+#define CLUSTER_LISTEN_LOCAL 2	/* a bare PORT on the loopback interface only */
+
+EXTERN_FUNCTION( int cluster_coordinate_parse, (char * inputline));
+EXTERN_FUNCTION( int cluster_worker_parse, (char * inputline));
+EXTERN_FUNCTION( int cluster_get_line, (char * inputline));
+EXTERN_FUNCTION( void cluster_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void cluster_coordinate, ());
+EXTERN_FUNCTION( void cluster_worker_start, ());
+EXTERN_FUNCTION( void cluster_worker_finish, ());
+EXTERN_FUNCTION( void cluster_service, ());
+EXTERN_FUNCTION( int cluster_socket, (char * address, int listening, int backlog));
+EXTERN_FUNCTION( void cluster_unlink_socket, (char * path));
+
+#endif
@@ -0,0 +1,309 @@
+/* elite.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Cooperative search with a shared elite board.  After the wff is
+   read gsat forks elite_workers - 1 worker processes, each with its
+   own random seed, that run tries just like the parent but print
+   nothing.  All of them share a board in anonymous shared memory
+   holding the best assignment any of them has found, one bit per var.
+
+   The board is written without locks.  Each process owns two slots
+   and writes its low assignment of a try into the one that is not on
+   the board.  The board's current word holds the slot on the board
+   and a version number; the writer puts its slot there with a
+   compare-and-swap, giving up as soon as the board holds an assignment
+   at least as good.  A reader copies the slot named by the current
+   word and then checks that the word has not changed, retrying if it
+   has: a slot is only rewritten after it has left the board, and the
+   version rules out its return unnoticed.
+
+   With a perturbation count M >= 0, each try starts from the board's
+   assignment with M random vars flipped, as the adaptive option does
+   with the process's own low assignment.  Once any worker satisfies
+   the wff, the parent takes its assignment at the end of its current
+   try.  Workers exit when they satisfy the wff, run out of tries, or
+   find that the parent has finished. */
+
+#include "gsat.h"
+#include "elite.h"
+#include "stream.h"
+#include "progress.h"
+#include "tempering.h"
+#include "utils.h"
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+EXTERN_FUNCTION( int fork, (void));
+EXTERN_FUNCTION( int getppid, (void));
+EXTERN_FUNCTION( void _exit, (int status));
+
+#define ELITE_MAX_WORKERS 64
+#define ELITE_SLOT_BITS 8
+#define ELITE_EMPTY ((1 << ELITE_SLOT_BITS) - 1)	/* slot of an empty board */
+#define ELITE_WORD_BITS ((int)(8 * sizeof(unsigned long)))
+
+#ifdef __GNUC__
+#define elite_cas(PTR, OLD, NEW) __sync_bool_compare_and_swap(PTR, OLD, NEW)
+#define elite_barrier() __sync_synchronize()
+#else
+#define elite_cas(PTR, OLD, NEW) (*(PTR) == (OLD) ? (*(PTR) = (NEW), 1) : 0)
+#define elite_barrier()
+#endif
+
+#define elite_slot_of(CUR) ((int)((CUR) & ELITE_EMPTY))
+#define elite_slot_bits(SLOT) (&elite_bits[(SLOT) * elite_words])
+
+struct elite_board_str {
+    volatile unsigned long current;	/* version << ELITE_SLOT_BITS | slot */
+    volatile int stop;			/* 1 = the parent has finished */
+    volatile int num_bad[2 * ELITE_MAX_WORKERS];	/* of each slot */
+};
+
+int elite_workers;		/* processes, counting the parent */
+int elite_perturb;		/* vars flipped in a board start; -1 = random starts */
+int elite_worker;		/* this process; 0 = parent */
+int elite_words;		/* unsigned longs per slot */
+int elite_pid[ELITE_MAX_WORKERS];
+struct elite_board_str *elite_board = NULL;
+unsigned long *elite_bits;	/* slots, after the board */
+int elite_publishes;		/* times this process put its assignment on the board */
+int elite_starts;		/* tries started from the board */
+int elite_adopted;		/* satisfying assignments taken from a worker */
+
+
+int
+elite_parse_parameters(PROTO(char *) inputline)
+     /* Parse "elite N [M]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    elite_workers = 0;
+    elite_perturb = -1;
+    sscanf(inputline, " elite %d %d", &elite_workers, &elite_perturb);
+#ifndef __GNUC__
+    crash_and_burn("ERROR: the elite option needs compare-and-swap\n");
+#endif
+    if (elite_workers < 1 || elite_workers > ELITE_MAX_WORKERS){
+	sprintf(ss, " Error: elite needs 1 to %d processes\n", ELITE_MAX_WORKERS);
+	crash_maybe(ss);
+	return 0;
+    }
+    if (elite_perturb >= 0)
+      printf(" option: elite board for %d processes, starts flip %d vars of the elite\n",
+	     elite_workers, elite_perturb);
+    else
+      printf(" option: elite board for %d processes, random starts\n", elite_workers);
+    elite_publishes = 0;
+    elite_starts = 0;
+    elite_adopted = 0;
+    return 1;
+}
+
+void
+elite_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_elite: %d\n", flag_elite);
+    fprintf(fp_report, "elite_workers: %d\n", elite_workers);
+    fprintf(fp_report, "elite_perturb: %d\n", elite_perturb);
+    fprintf(fp_report, "elite_publishes: %d\n", elite_publishes);
+    fprintf(fp_report, "elite_starts: %d\n", elite_starts);
+    fprintf(fp_report, "elite_adopted: %d\n", elite_adopted);
+    if (elite_board != NULL && elite_slot_of(elite_board->current) != ELITE_EMPTY)
+      fprintf(fp_report, "elite_board_bad: %d\n",
+	      elite_board->num_bad[elite_slot_of(elite_board->current)]);
+}
+
+void
+elite_start()
+     /* Make the board and fork the workers; called once the wff is read */
+{
+    int w, pid, seed;
+    size_t size;
+
+    if (flag_graphics)
+      crash_and_burn("ERROR: elite cannot be used with graphics\n");
+
+    elite_words = (nvars + ELITE_WORD_BITS) / ELITE_WORD_BITS;
+    size = sizeof(struct elite_board_str) +
+      (size_t)(2 * elite_workers * elite_words) * sizeof(unsigned long);
+    elite_board = (struct elite_board_str *)
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (elite_board == (struct elite_board_str *) MAP_FAILED)
+      crash_and_burn("ERROR: cannot map the elite board\n");
+    elite_bits = (unsigned long *) (elite_board + 1);
+    elite_board->current = ELITE_EMPTY;
+    elite_board->stop = 0;
+
+    fflush(stdout);
+    fflush(try_stat_filep);
+    if (flag_stream) stream_flush();
+    elite_worker = 0;
+    for (w = 1; w < elite_workers; w++){
+	/* drawn by the parent, so that runs can be repeated from the seed */
+	seed = random_1_to(INT_PROB_BASE);
+	pid = fork();
+	if (pid < 0)
+	  crash_and_burn("ERROR: elite cannot fork\n");
+	if (pid == 0){
+	    elite_worker = w;
+	    flag_trace = 0;
+	    flag_stream = 0;
+	    flag_record = 0;
+	    flag_phases = 0;
+	    report_interval = BIG;
+	    if (flag_progress) progress_attach(w);
+	    signal(SIGINT, SIG_IGN);
+	    signal(SIGQUIT, SIG_IGN);
+	    signal(SIGTERM, SIG_DFL);
+	    freopen("/dev/null", "w", stdout);
+	    /* the scratch file's offset is shared with the parent */
+	    fclose(try_stat_filep);
+	    if ((try_stat_filep = tmpfile()) == NULL)
+	      _exit(1);
+	    tempering_reseed(seed);
+	    return;
+	}
+	elite_pid[w] = pid;
+    }
+}
+
+static void
+elite_write_slot(PROTO(int) slot)
+     /* Pack this process's low assignment into a slot */
+PARAMS( int slot; )
+{
+    unsigned long *c;
+    int i;
+    var_str_ptr var_ptr;
+
+    c = elite_slot_bits(slot);
+    for (i = 0; i < elite_words; i++) c[i] = 0;
+    for (i = 1, var_ptr = &assign[1]; i <= nvars; i++, var_ptr++)
+      if (var_ptr->value_low > 0)
+	c[i / ELITE_WORD_BITS] |= 1UL << (i % ELITE_WORD_BITS);
+}
+
+static int
+elite_read_board()
+     /* Copy the board's assignment into the values; returns its
+	num_bad, or BIG if the board is empty */
+{
+    unsigned long cur, *c;
+    int i, num_bad;
+    var_str_ptr var_ptr;
+
+    do {
+	cur = elite_board->current;
+	if (elite_slot_of(cur) == ELITE_EMPTY) return BIG;
+	elite_barrier();
+	c = elite_slot_bits(elite_slot_of(cur));
+	num_bad = elite_board->num_bad[elite_slot_of(cur)];
+	for (i = 1, var_ptr = &assign[1]; i <= nvars; i++, var_ptr++)
+	  var_ptr->value = ((c[i / ELITE_WORD_BITS] >> (i % ELITE_WORD_BITS)) & 1) ? 1 : -1;
+	elite_barrier();
+    } while (elite_board->current != cur);
+    return num_bad;
+}
+
+int
+elite_init_values()
+     /* Start a try from the board; returns 0, leaving the start to
+	init_assign_values, for random starts or an empty board */
+{
+    int i;
+    var_str_ptr var_ptr;
+
+    if (elite_perturb < 0 || elite_read_board() == BIG) return 0;
+    for (i = 1; i <= elite_perturb; i++)
+      assign[random_1_to(nvars)].value *= -1;
+    for (i = 1, var_ptr = &assign[1]; i <= nvars; i++, var_ptr++)
+      var_ptr->value_low = var_ptr->prev_low = var_ptr->value;
+    elite_starts++;
+    return 1;
+}
+
+void
+elite_end_try()
+     /* Called by the parent when a try ends: if a worker has satisfied
+	the wff, take its assignment */
+{
+    unsigned long cur;
+
+    if (elite_worker || current_num_bad == 0) return;
+    cur = elite_board->current;
+    if (elite_slot_of(cur) == ELITE_EMPTY || elite_board->num_bad[elite_slot_of(cur)] != 0)
+      return;
+
+    clear_out_lists();
+    elite_read_board();
+    init_diff();
+    init_tabu();
+    init_buckets();
+    current_num_bad = get_bad_clauses(0, 0);
+    if (current_num_bad == 0){
+	elite_adopted++;
+	low_bad = 0;
+	save_current_as_low();
+    }
+}
+
+void
+elite_publish(PROTO(int) num_bad)
+     /* Offer the low assignment of the try, with num_bad bad clauses,
+	to the board; then a worker exits if it is done */
+PARAMS( int num_bad; )
+{
+    unsigned long cur;
+    int slot;
+
+    cur = elite_board->current;
+    if (elite_slot_of(cur) == ELITE_EMPTY || num_bad < elite_board->num_bad[elite_slot_of(cur)]){
+	slot = 2 * elite_worker;
+	if (elite_slot_of(cur) == slot) slot++;
+	elite_write_slot(slot);
+	elite_board->num_bad[slot] = num_bad;
+	elite_barrier();
+	while (!elite_cas(&elite_board->current, cur,
+			  ((cur >> ELITE_SLOT_BITS) + 1) << ELITE_SLOT_BITS | slot)){
+	    cur = elite_board->current;
+	    if (elite_slot_of(cur) != ELITE_EMPTY &&
+		num_bad >= elite_board->num_bad[elite_slot_of(cur)])
+	      break;
+	}
+	if (elite_slot_of(elite_board->current) == slot) elite_publishes++;
+    }
+
+    if (elite_worker &&
+	(num_bad == 0 || current_try >= max_tries || elite_board->stop || getppid() == 1 ||
+	 elite_board->num_bad[elite_slot_of(elite_board->current)] == 0))
+      _exit(0);
+}
+
+void
+elite_stop()
+     /* Called by the parent when it finishes: end the workers */
+{
+    int w;
+
+    if (elite_worker || elite_board == NULL) return;
+    elite_board->stop = 1;
+    for (w = 1; w < elite_workers; w++){
+	kill(elite_pid[w], SIGKILL);
+	waitpid(elite_pid[w], NULL, 0);
+    }
+}
@@ -0,0 +1,26 @@
+/* elite.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef ELITE_H
+#define ELITE_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int elite_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void elite_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void elite_start, ());
+EXTERN_FUNCTION( int elite_init_values, ());
+EXTERN_FUNCTION( void elite_end_try, ());
+EXTERN_FUNCTION( void elite_publish, (int num_bad));
+EXTERN_FUNCTION( void elite_stop, ());
+
+#endif
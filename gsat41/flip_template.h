@@ -0,0 +1,469 @@
+/* flip_template.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* The flip loop: picking, flipping, and updating diffs and buckets.
+   This file is included by gsat.c several times.  Included with
+   SPEC_CONFIG undefined, it defines the generic routines update_diff(),
+   flip_var(), pick_rand_var(), ..., try_flips(), which test every
+   option at run time.  Included with SPEC_CONFIG defined as a constant
+   mask of SPEC_CONFIG_* bits and SPEC(name) defined to paste a suffix
+   onto name, it defines static copies of those routines for exactly
+   that configuration, in which the option tests are constants and
+   compile away.  The specialized copies do not support coloring,
+   only_unsat, graphics, pausing, annealing, paws, novelty, ccanr,
+   probsat, plateaus, bigflip, direction limits, manual picks, or
+   per-flip tracing, and as none of those remain they do not keep the
+   false clause list either;
+   flip_loop_config() in gsat.c decides which copy to run. */
+
+#ifndef FLIP_TEMPLATE_H
+#define FLIP_TEMPLATE_H
+
+#define SPEC_CONFIG_HILLCLIMB 1	/* flag_hillclimb */
+#define SPEC_CONFIG_WALK 2	/* flag_walk != 0 */
+#define SPEC_CONFIG_TABU 4	/* tabu_list_length > 0 */
+#define SPEC_CONFIG_WEIGH 8	/* flag_weigh_clauses */
+#define SPEC_CONFIG_PB 16	/* flag_pb */
+#define SPEC_CONFIG_RECORD 32	/* flag_record */
+#define SPEC_CONFIG_COUNT 64	/* number of specialized configurations */
+
+#endif
+
+#ifdef SPEC_CONFIG
+#define SPEC_GENERIC 0
+#define SPEC_STATIC static
+#define SPEC_HILLCLIMB ((SPEC_CONFIG & SPEC_CONFIG_HILLCLIMB) != 0)
+#define SPEC_WALK ((SPEC_CONFIG & SPEC_CONFIG_WALK) != 0)
+#define SPEC_TABU ((SPEC_CONFIG & SPEC_CONFIG_TABU) != 0)
+#define SPEC_WEIGH ((SPEC_CONFIG & SPEC_CONFIG_WEIGH) != 0)
+#define SPEC_PB ((SPEC_CONFIG & SPEC_CONFIG_PB) != 0)
+#define SPEC_RECORD ((SPEC_CONFIG & SPEC_CONFIG_RECORD) != 0)
+#define SPEC_ONLY_UNSAT 0
+#define SPEC_COLORING 0
+#define SPEC_NOTICE_CLAUSE_STATE 0
+#define SPEC_FALSE_CLAUSES 0
+#else
+#define SPEC_GENERIC 1
+#define SPEC(name) name
+#define SPEC_STATIC
+#define SPEC_HILLCLIMB flag_hillclimb
+#define SPEC_WALK flag_walk
+#define SPEC_TABU (tabu_list_length > 0)
+#define SPEC_WEIGH flag_weigh_clauses
+#define SPEC_PB flag_pb
+#define SPEC_RECORD flag_record
+#define SPEC_ONLY_UNSAT flag_only_unsat
+#define SPEC_COLORING flag_coloring
+#define SPEC_NOTICE_CLAUSE_STATE ((flag_trace & FLAG_TRACE_CLAUSE_STATE)||flag_graphics)
+#define SPEC_FALSE_CLAUSES (!flag_coloring)
+#endif
+
+/* Note how the var to flip was picked, for the record option */
+#define SPEC_SOURCE(SOURCE) { if (SPEC_RECORD) record_source = (SOURCE); }
+
+#undef BUCKET_HILLCLIMB
+#undef BUCKET_ONLY_UNSAT
+#define BUCKET_HILLCLIMB SPEC_HILLCLIMB
+#define BUCKET_ONLY_UNSAT SPEC_ONLY_UNSAT
+
+
+SPEC_STATIC int
+SPEC(pick_greedy_var)()
+{
+    int var;
+
+    if (SPEC_HILLCLIMB){
+	if (SPEC_TABU){
+	    return ((var = allowed_member_down(1)) ||
+		    (var = allowed_member_sideways(1)) ||
+		    (var = allowed_member_up(1))) ? var : 0;
+	}
+	return length_of(down) ? random_member(down)
+	  : ( length_of(sideways) ? random_member(sideways)
+	     : random_member(up) );
+    }
+    else {
+	return SPEC_TABU ? score_random_allowed() : score_random_member();
+    }
+}
+
+
+SPEC_STATIC int
+SPEC(pick_rand_var)()
+{
+    int var;
+
+#if SPEC_GENERIC
+    if (flag_trace & FLAG_TRACE_DIFFS){
+	if (flag_hillclimb){
+	    print_list(down, diff, "DOWN: Vars with diff>0 : ");
+	    print_list(sideways, diff, "SIDEWAYS: Vars with diff=0 : ");
+	    print_list(up, diff, "UP: Vars with diff<0 : ");
+	}
+	else {
+	    score_print("MAXDIFF: Vars with max diff: ");
+	}
+    }
+    if (flag_trace & FLAG_TRACE_MAKES)
+      print_list(walk, make, "WALK: Vars with make>0 : ");
+    if (flag_trace & FLAG_TRACE_TABU)
+      print_tabu_list();
+
+    if (flag_manual_pick){
+	printf(">>>> For flip %d, I should pick : ", flip + 1);
+	scanf("%d", &var);
+	SPEC_SOURCE(RECORD_MANUAL);
+	if (var) return var;
+    }
+
+    if (flag_anneal){
+	SPEC_SOURCE(RECORD_ANNEAL);
+	return (anneal_pick_var());
+    }
+
+    if (flag_novelty){
+	SPEC_SOURCE(RECORD_NOVELTY);
+	return novelty_pick_var();
+    }
+
+    if (flag_ccanr){
+	SPEC_SOURCE(RECORD_CCANR);
+	return ccanr_pick_var();
+    }
+
+    if (flag_probsat){
+	SPEC_SOURCE(RECORD_PROBSAT);
+	return probsat_pick_var();
+    }
+
+    if ((flag_plateau) && (flag_plateau >= current_num_bad)){
+	SPEC_SOURCE(RECORD_PLATEAU);
+	return plateau_pick_var();
+    }
+#endif
+
+    if (SPEC_WALK){
+	if ((flag_walk < 0 && random_01_odds(-flag_walk))
+	    ||
+	    (flag_walk > 0 && current_max_diff <= 0 && random_01_odds(flag_walk))){
+	    var = 0;
+	    if (!flag_walk_all_vars){
+		if (SPEC_TABU)
+		  var = allowed_member_walk(1);
+		else if (length_of(walk))
+		  var = random_member(walk);
+	    }
+	    if (var == 0)
+	      var = random_1_to(nvars);
+	    SPEC_SOURCE(RECORD_WALK);
+#if SPEC_GENERIC
+	    if (flag_trace & FLAG_TRACE_WALKS)
+	      printf("Walk var=%d, diff=%d, make=%d\n", var, assign[var].diff, assign[var].make);
+#endif
+	    return var;
+	}
+    }
+
+    SPEC_SOURCE(RECORD_GREEDY);
+    return SPEC(pick_greedy_var)();
+}
+
+
+SPEC_STATIC void
+SPEC(update_diff)(PROTO(int) var)
+     /* Update diffs for var, including implicit clauses */
+PARAMS(int var;)
+{
+    wff_str_ptr clause_ptr;
+    wff_str_ptr clause_start;
+    var_str_ptr var_ptr, other_var_ptr, alit_ptr;
+    int i, lit, alit, clause_len, npos, var_makes_clause, next_clause;
+    int offset;
+    int weight;
+    int this_clause;
+
+    var_ptr = &assign[var];
+    offset = SPEC_COLORING ? ((var - 1) % flag_coloring) : 0;
+    next_clause = assign[var - offset].first;
+
+    /* printf("Update var=%d offset=%d\n", var, offset); */
+
+    while (next_clause != -1) {
+
+	clause_len = (clause_ptr = clause_start = &wff[this_clause = next_clause])->lit;
+	weight = SPEC_WEIGH ? clause_ptr->next : 1;
+	clause_ptr++;
+
+	/* printf("Testing clause "); */
+	/* print_clause(next_clause); */
+
+	npos = 0;
+	var_makes_clause = 0;
+	for (i = 1; i <= clause_len; i++) {
+
+	    if ((lit = clause_ptr->lit ) < 0){
+		if ((alit = -lit  + offset)==var){
+		    next_clause = clause_ptr->next;
+		    /* printf("next clause =%d  ", next_clause); */
+		}
+	    }
+	    else {
+		if ((alit = lit)==(var - offset)){
+		    next_clause = clause_ptr->next;
+		    /* printf("next clause =%d  ", next_clause); */
+		}
+	    }
+
+	    /* printf("Alit = %d  ", alit); */
+
+	    if (same_sign((alit_ptr = &assign[alit])->value, lit)){
+		npos ++;
+		if (alit == var) {
+		    var_makes_clause = 1;
+		}
+		else {
+		    other_var_ptr = alit_ptr;
+		}
+	    }
+	    clause_ptr++;
+	}
+
+	/* printf(" npos = %d, var_makes_clause = %d, other_var=%d \n", npos, var_makes_clause, (int) (other_var_ptr - assign));  */
+
+	if ((npos == 1) && !var_makes_clause) {
+	    /* other_var becomes critical */
+	    other_var_ptr->diff -= weight;
+	    adjust_bucket(other_var_ptr);
+	}
+	else if ((npos == 2) && var_makes_clause){
+	    /* other_var becomes uncritical */
+	    other_var_ptr->diff += weight;
+	    adjust_bucket(other_var_ptr);
+	}
+	else if (npos == 0){
+	    /* clause becomes unsat */
+	    if (SPEC_NOTICE_CLAUSE_STATE)
+	      trace_clause_state(this_clause, -1);
+	    if (SPEC_FALSE_CLAUSES) add_false_clause(this_clause);
+	    current_num_bad++;
+	    clause_ptr = clause_start + 1;
+	    for (i = 1 ; i <= clause_len ; i++) {
+		if ((lit = clause_ptr->lit)<0)
+		  alit = -lit + offset;
+		else
+		  alit = lit;
+		(alit_ptr = &assign[alit])->diff += weight;
+		alit_ptr->make += weight;
+		if (alit != var) adjust_bucket(alit_ptr);
+		clause_ptr++;
+	    }
+	    var_ptr->diff += weight;
+	}
+	else if (npos == 1) {
+	    /* clause becomes pos; reduce makes; var becomes critical */
+	    if (SPEC_NOTICE_CLAUSE_STATE)
+	      trace_clause_state(this_clause, 1);
+	    if (SPEC_FALSE_CLAUSES) delete_false_clause(this_clause);
+	    current_num_bad-- ;
+	    clause_ptr = clause_start + 1;
+	    for (i = 1 ; i <= clause_len ; i++) {
+		if ((lit = clause_ptr->lit)<0)
+		  alit = -lit + offset;
+		else
+		  alit = lit;
+		(alit_ptr = &assign[alit])->diff -= weight;
+
+		alit_ptr->make -= weight;
+		if (alit != var) adjust_bucket(alit_ptr);
+		clause_ptr++;
+	    }
+	    var_ptr->diff -= weight;
+	}
+    }
+    if (SPEC_PB) pb_update_diff(var);
+    adjust_bucket(var_ptr);
+}
+
+
+SPEC_STATIC int
+SPEC(compute_max_diff)()
+{
+    if (SPEC_HILLCLIMB){
+	if (SPEC_TABU)
+	  return allowed_member_down(0) ? 1 :
+	    ( allowed_member_sideways(0) ? 0 : -1 );
+	return length_of(down) ? 1 :
+	  ( length_of(sideways) ? 0 : -1 );
+    }
+    else {
+	return SPEC_TABU ? score_max_allowed() : score_max();
+    }
+}
+
+
+SPEC_STATIC void
+SPEC(flip_var)(PROTO(int) var)
+     /* flip var and update make/critical/diff and max_diff_list */
+PARAMS( int var; )
+{
+    int diff, make;
+    int old_num_bad;
+
+    old_num_bad = current_num_bad;
+    diff = assign[var].diff;
+    make = assign[var].make;
+
+    if (diff < 0)
+      ++upwards_count;
+    else if (diff == 0)
+      ++sideways_count;
+    else
+      ++downwards_count;
+    assign[var].flip_count++;
+
+#if SPEC_GENERIC
+    if ((flag_trace & FLAG_TRACE_FLIPS)){
+	printf("Flip %d: var %d to %d, diff=%d, make=%d, num_bad=%d, low_bad=%d\n",
+	       flip, var, -assign[var].value, assign[var].diff,
+	       assign[var].make,
+	       current_num_bad,
+	       low_bad);
+    }
+#endif
+
+    CHECK({
+	if (SPEC_ONLY_UNSAT && assign[var].make <= 0){
+	    sprintf(ss, "Flipping var %d, but it has make %d\n",
+		    var, assign[var].make);
+	    crash_and_burn(ss);
+	}
+    });
+
+    assign[var].value *= -1;
+
+    /* Tabu vars are not removed from the buckets, so nothing has to
+       be put back when they expire; see is_tabu */
+    assign[var].last_flip = flip;
+
+    SPEC(update_diff)(var);
+    if (SPEC_RECORD) record_flip(var, diff, make);
+
+#if SPEC_GENERIC
+    if (flag_ccanr) ccanr_flipped(var);
+#endif
+
+#if SPEC_GENERIC
+    if (flag_trace & FLAG_TRACE_FLIP_CLAUSES){
+	if (get_bad_clauses(1, 0) != current_num_bad){
+	    sprintf(ss, "current_num_bad=%d, but actual count is %d!\n",
+		    current_num_bad, get_bad_clauses(0,0));
+	    crash_and_burn(ss);
+	}
+    }
+
+    if (flag_trace & FLAG_TRACE_ASSIGN)
+      print_assign_stdout();
+#endif
+
+    CHECK({
+	if (!SPEC_WEIGH){
+	    if (current_num_bad != (old_num_bad - diff)){
+		sprintf(ss, "Diff = %d, but current_num_bad changes from %d to %d!\n",
+			diff, old_num_bad, current_num_bad);
+		crash_and_burn(ss);
+	    }
+	}
+    });
+
+    if (current_num_bad < low_bad ){
+	low_bad = current_num_bad;
+	if (current_num_bad <= flag_save_best_max){
+	    save_current_as_low();
+	}
+    }
+
+    if (current_num_bad < best_num_bad && current_num_bad <= flag_save_best_max){
+	save_current_as_best();
+    }
+
+#if SPEC_GENERIC
+    if (flag_graphics) graphics_show_variable(var, 1);
+#ifndef NO_USLEEP
+    if (pause_usecs)
+      usleep(pause_usecs);
+#endif
+#endif
+}
+
+
+SPEC_STATIC void
+SPEC(try_flips)()
+     /* Flip until the try ends: formula satisfied, max_flips
+	(plus boost) reached, or no variable to pick */
+{
+    int var;
+
+    while (flip < max_flips || (boost_on && flip < max_flips + boost_amount)){
+
+#if SPEC_GENERIC
+	if (flag_graphics) graphics_start_flip();
+#endif
+
+	if (signals_pending) service_signals();
+	if (current_num_bad == 0) break;
+	current_max_diff = SPEC(compute_max_diff)();
+#if SPEC_GENERIC
+	if (flag_paws && current_max_diff <= 0 && paws_local_minimum())
+	  current_max_diff = compute_max_diff();
+	if (flag_direction == 1 && current_max_diff <= 0) break;
+	if (flag_direction == 2 && current_max_diff < 0) break;
+	if (flag_bigflip){
+	    flip++;
+	    big_flip();
+	}
+	else
+#endif
+	{
+	    var = SPEC(pick_rand_var)();
+	    if (var == 0) break;
+	    flip++;
+	    SPEC(flip_var)(var);
+	}
+	if (flip == max_flips && current_num_bad <= boost_threshhold){
+	    boost_on = 1;
+	    if (flag_trace) printf("BOOSTING\n");
+	}
+    }
+}
+
+
+#undef BUCKET_HILLCLIMB
+#undef BUCKET_ONLY_UNSAT
+#define BUCKET_HILLCLIMB flag_hillclimb
+#define BUCKET_ONLY_UNSAT flag_only_unsat
+
+#undef SPEC_GENERIC
+#undef SPEC_STATIC
+#undef SPEC_HILLCLIMB
+#undef SPEC_WALK
+#undef SPEC_TABU
+#undef SPEC_WEIGH
+#undef SPEC_PB
+#undef SPEC_RECORD
+#undef SPEC_SOURCE
+#undef SPEC_ONLY_UNSAT
+#undef SPEC_COLORING
+#undef SPEC_NOTICE_CLAUSE_STATE
+#undef SPEC_FALSE_CLAUSES
+#undef SPEC_CONFIG
+#undef SPEC
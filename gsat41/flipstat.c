@@ -0,0 +1,377 @@
+/* flipstat.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Read a file written by the "record" option of gsat and print
+
+       a summary:   flips by source and by direction, and the best try;
+       -text:       the lines "trace flips" and "trace walks" would
+                    have printed;
+       -vars N:     the N vars flipped most often;
+       -plateaus:   the lengths of runs of sideways flips;
+       -cycles W:   returns to an assignment visited within the last
+                    W flips (up to 2W), by distance.
+
+   Usage: flipstat [-text] [-vars N] [-plateaus] [-cycles W] FILE
+
+   Cycles are found by hashing the assignment: each var has a random
+   64-bit key, and the hash of an assignment is the xor of the keys of
+   the vars flipped an odd number of times since the start of the try.
+   The hashes of the last W flips are kept in one table and those of
+   the W before in another, so memory is independent of the run. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "proto.h"
+#include "record.h"
+
+#define BIG 0x7fffffff
+#define FLIPSTAT_BLOCK 65536	/* records read at a time */
+#define FLIPSTAT_BUCKETS 32	/* power-of-2 histogram buckets */
+
+typedef unsigned long long flipstat_hash;
+
+static char * source_names[] = RECORD_SOURCE_NAMES;
+
+struct record_header_str header;
+int flag_text, flag_vars, flag_plateaus, flag_cycles;
+
+long source_count[RECORD_SOURCES];
+long downwards, sideways, upwards, flips, tries;
+int best_num_bad = BIG, best_try, best_flip;
+long * var_count;
+
+long plateau_hist[FLIPSTAT_BUCKETS];
+long plateau_run, plateau_longest, plateau_total, plateau_runs;
+int plateau_try, plateau_flip;	/* where the current run started */
+int plateau_longest_try, plateau_longest_flip;
+
+flipstat_hash * var_key;
+flipstat_hash cycle_state;
+flipstat_hash * cycle_table[2];	/* [0] the last W flips, [1] the W before */
+long * cycle_flip[2];		/* flip number of each entry, -1 if empty */
+long cycle_size, cycle_filled, cycle_step;	/* cycle_filled: flips in table [0] */
+long cycle_hist[FLIPSTAT_BUCKETS];
+long cycle_returns;
+
+
+static void
+usage()
+{
+    fprintf(stderr, "Usage: flipstat [-text] [-vars N] [-plateaus] [-cycles W] FILE\n");
+    exit(-1);
+}
+
+static int
+bucket_of(PROTO(long) n)
+     /* Bucket k holds 2^k .. 2^(k+1)-1 */
+PARAMS( long n; )
+{
+    int k;
+
+    for (k = 0; n > 1 && k < FLIPSTAT_BUCKETS - 1; k++) n >>= 1;
+    return k;
+}
+
+static void
+print_hist(PROTO(long *) hist, PROTO(char *) what)
+PARAMS( long * hist; char * what; )
+{
+    int k;
+
+    for (k = 0; k < FLIPSTAT_BUCKETS; k++)
+      if (hist[k])
+	printf("  %s %ld-%ld: %ld\n", what, 1L << k, (1L << (k + 1)) - 1, hist[k]);
+}
+
+
+/* Plateaus */
+
+static void
+plateau_end()
+     /* The current run of sideways flips, if any, is over */
+{
+    if (plateau_run == 0) return;
+    plateau_hist[bucket_of(plateau_run)]++;
+    plateau_total += plateau_run;
+    plateau_runs++;
+    if (plateau_run > plateau_longest){
+	plateau_longest = plateau_run;
+	plateau_longest_try = plateau_try;
+	plateau_longest_flip = plateau_flip;
+    }
+    plateau_run = 0;
+}
+
+
+/* Cycles */
+
+static flipstat_hash
+next_key()
+     /* xorshift64* */
+{
+    static flipstat_hash x = 88172645463325252ULL;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    return x * 2685821657736338717ULL;
+}
+
+static void
+cycle_init()
+{
+    int i;
+
+    var_key = (flipstat_hash *) malloc((size_t)(header.nvars + 1) * sizeof(flipstat_hash));
+    for (cycle_size = 1; cycle_size < 2 * cycle_step; cycle_size *= 2);
+    for (i = 0; i < 2; i++){
+	cycle_table[i] = (flipstat_hash *) malloc((size_t) cycle_size * sizeof(flipstat_hash));
+	cycle_flip[i] = (long *) malloc((size_t) cycle_size * sizeof(long));
+    }
+    if (var_key == NULL || cycle_table[0] == NULL || cycle_table[1] == NULL ||
+	cycle_flip[0] == NULL || cycle_flip[1] == NULL){
+	fprintf(stderr, "flipstat: cannot allocate cycle tables\n");
+	exit(-1);
+    }
+    for (i = 0; i <= header.nvars; i++) var_key[i] = next_key();
+}
+
+static void
+cycle_clear(PROTO(int) t)
+PARAMS( int t; )
+{
+    long i;
+
+    for (i = 0; i < cycle_size; i++) cycle_flip[t][i] = -1;
+}
+
+static long
+cycle_slot(PROTO(int) t, PROTO(flipstat_hash) h)
+     /* Slot of h in table t, or the empty slot where it would go */
+PARAMS( int t; flipstat_hash h; )
+{
+    long i;
+
+    for (i = (long)(h & (cycle_size - 1));
+	 cycle_flip[t][i] >= 0 && cycle_table[t][i] != h;
+	 i = (i + 1) & (cycle_size - 1));
+    return i;
+}
+
+static void
+cycle_start_try()
+{
+    cycle_state = 0;
+    cycle_clear(0);
+    cycle_clear(1);
+    cycle_filled = 0;
+    cycle_table[0][cycle_slot(0, cycle_state)] = cycle_state;
+    cycle_flip[0][cycle_slot(0, cycle_state)] = 0;
+    cycle_filled = 1;
+}
+
+static void
+cycle_flip_var(PROTO(int) var, PROTO(long) flip)
+PARAMS( int var; long flip; )
+{
+    flipstat_hash * swap_table;
+    long * swap_flip;
+    long i, seen;
+    int t;
+
+    cycle_state ^= var_key[var];
+    seen = -1;
+    for (t = 0; t < 2 && seen < 0; t++){
+	i = cycle_slot(t, cycle_state);
+	if (cycle_flip[t][i] >= 0) seen = cycle_flip[t][i];
+    }
+    if (seen >= 0){
+	cycle_returns++;
+	cycle_hist[bucket_of(flip - seen)]++;
+    }
+
+    if (cycle_filled == cycle_step){
+	/* the last W become the W before */
+	swap_table = cycle_table[1]; cycle_table[1] = cycle_table[0]; cycle_table[0] = swap_table;
+	swap_flip = cycle_flip[1]; cycle_flip[1] = cycle_flip[0]; cycle_flip[0] = swap_flip;
+	cycle_clear(0);
+	cycle_filled = 0;
+    }
+    i = cycle_slot(0, cycle_state);
+    cycle_filled++;
+    cycle_table[0][i] = cycle_state;
+    cycle_flip[0][i] = flip;
+}
+
+
+int
+main(PROTO(int) argc, PROTO(char **) argv)
+PARAMS( int argc; char ** argv; )
+{
+    FILE * fp;
+    struct record_str * block;
+    struct record_str * r;
+    long left, got, i, max_count;
+    int try, low_bad, num_bad, var, arg, j, k, best;
+    char * file;
+
+    file = NULL;
+    for (arg = 1; arg < argc; arg++){
+	if (strcmp(argv[arg], "-text") == 0) flag_text = 1;
+	else if (strcmp(argv[arg], "-plateaus") == 0) flag_plateaus = 1;
+	else if (strcmp(argv[arg], "-vars") == 0 && arg + 1 < argc)
+	  flag_vars = atoi(argv[++arg]);
+	else if (strcmp(argv[arg], "-cycles") == 0 && arg + 1 < argc){
+	    flag_cycles = 1;
+	    cycle_step = atol(argv[++arg]);
+	    if (cycle_step < 1) usage();
+	}
+	else if (argv[arg][0] == '-' || file != NULL) usage();
+	else file = argv[arg];
+    }
+    if (file == NULL) usage();
+
+    if ((fp = fopen(file, "r")) == NULL){
+	fprintf(stderr, "flipstat: cannot open %s\n", file);
+	exit(-1);
+    }
+    if (fread((char *) &header, sizeof(header), 1, fp) != 1 ||
+	strncmp(header.magic, RECORD_MAGIC, sizeof(header.magic)) != 0 ||
+	header.version != RECORD_VERSION ||
+	header.record_size != sizeof(struct record_str)){
+	fprintf(stderr, "flipstat: %s is not a record file of this version\n", file);
+	exit(-1);
+    }
+
+    var_count = (long *) calloc((size_t)(header.nvars + 1), sizeof(long));
+    block = (struct record_str *) malloc((size_t) FLIPSTAT_BLOCK * sizeof(struct record_str));
+    if (var_count == NULL || block == NULL){
+	fprintf(stderr, "flipstat: cannot allocate\n");
+	exit(-1);
+    }
+    if (flag_cycles) cycle_init();
+
+    try = 0;
+    low_bad = num_bad = BIG;
+    for (left = header.records; left > 0; left -= got){
+	got = fread((char *) block, sizeof(struct record_str),
+		    (size_t)(left < FLIPSTAT_BLOCK ? left : FLIPSTAT_BLOCK), fp);
+	if (got <= 0){
+	    fprintf(stderr, "flipstat: %s ends after %ld of %lld records\n",
+		    file, (long)(header.records - left), header.records);
+	    break;
+	}
+	for (i = 0, r = block; i < got; i++, r++){
+	    if (r->source == RECORD_TRY){
+		if (flag_plateaus) plateau_end();
+		try = r->flip;
+		tries++;
+		low_bad = BIG;
+		num_bad = r->num_bad;
+		if (flag_text) printf("Try %d: init_bad=%d\n", try, num_bad);
+		if (flag_cycles) cycle_start_try();
+		if (num_bad < best_num_bad){
+		    best_num_bad = num_bad;
+		    best_try = try;
+		    best_flip = 0;
+		}
+		continue;
+	    }
+	    var = (r->var > 0) ? r->var : -r->var;
+	    if (var > header.nvars || r->source < 0 || r->source >= RECORD_SOURCES){
+		fprintf(stderr, "flipstat: bad record %ld\n", (long)(header.records - left + i));
+		exit(-1);
+	    }
+	    flips++;
+	    source_count[r->source]++;
+	    var_count[var]++;
+	    if (r->diff > 0) downwards++;
+	    else if (r->diff == 0) sideways++;
+	    else upwards++;
+
+	    if (flag_text){
+		if (r->source == RECORD_WALK)
+		  printf("Walk var=%d, diff=%d, make=%d\n", var, r->diff, r->make);
+		printf("Flip %d: var %d to %d, diff=%d, make=%d, num_bad=%d, low_bad=%d\n",
+		       r->flip, var, (r->var > 0) ? 1 : -1, r->diff, r->make, num_bad, low_bad);
+	    }
+	    if (flag_plateaus){
+		if (r->diff != 0)
+		  plateau_end();
+		else if (plateau_run++ == 0){
+		    plateau_try = try;
+		    plateau_flip = r->flip;
+		}
+	    }
+	    if (flag_cycles) cycle_flip_var(var, (long) r->flip);
+
+	    num_bad = r->num_bad;
+	    if (num_bad < low_bad) low_bad = num_bad;
+	    if (num_bad < best_num_bad){
+		best_num_bad = num_bad;
+		best_try = try;
+		best_flip = r->flip;
+	    }
+	}
+    }
+    if (flag_plateaus) plateau_end();
+    fclose(fp);
+
+    printf("record_file: %s\n", file);
+    printf("nvars: %d\nnclauses: %d\nmax_flips: %d\nmax_tries: %d\nseed1: %d\nseed2: %d\n",
+	   header.nvars, header.nclauses, header.max_flips, header.max_tries,
+	   header.seed1, header.seed2);
+    printf("records: %lld\ntries: %ld\nflips: %ld\n", header.records, tries, flips);
+    printf("downwards: %ld\nsideways: %ld\nupwards: %ld\n", downwards, sideways, upwards);
+    for (k = 0; k < RECORD_SOURCES; k++)
+      if (source_count[k])
+	printf("source_%s: %ld\n", source_names[k], source_count[k]);
+    printf("best_num_bad: %d\nbest_try: %d\nbest_flip: %d\n", best_num_bad, best_try, best_flip);
+
+    if (flag_vars){
+	printf("\nMost flipped vars:\n");
+	for (j = 0; j < flag_vars; j++){
+	    best = 0;
+	    max_count = 0;
+	    for (var = 1; var <= header.nvars; var++)
+	      if (var_count[var] > max_count){
+		  max_count = var_count[var];
+		  best = var;
+	      }
+	    if (best == 0) break;
+	    printf("  var %d: %ld flips (%.2f%%)\n", best, max_count,
+		   flips ? 100.0 * max_count / flips : 0.0);
+	    var_count[best] = -var_count[best];	/* skip it next time */
+	}
+	for (var = 1; var <= header.nvars; var++)
+	  if (var_count[var] < 0) var_count[var] = -var_count[var];
+    }
+
+    if (flag_plateaus){
+	printf("\nPlateaus (runs of sideways flips):\n");
+	printf("  runs: %ld\n  mean_length: %.2f\n", plateau_runs,
+	       plateau_runs ? (double) plateau_total / plateau_runs : 0.0);
+	printf("  longest: %ld, in try %d from flip %d\n", plateau_longest,
+	       plateau_longest_try, plateau_longest_flip);
+	print_hist(plateau_hist, "length");
+    }
+
+    if (flag_cycles){
+	printf("\nCycles (returns to an assignment within %ld to %ld flips):\n",
+	       cycle_step, 2 * cycle_step);
+	printf("  returns: %ld\n", cycle_returns);
+	print_hist(cycle_hist, "distance");
+    }
+    return 0;
+}
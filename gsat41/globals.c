@@ -28,10 +28,6 @@ var_str_ptr assign;		/* assign is global array containing the assignment */
 				/* variable n stored at assign[n] */
 				/* size = nvars + 1 */
 
-int
-  tabu_in,			/* indexes of first/last element in tabu list */
-  tabu_out;
-
 bad_clause_count_str_ptr bad_clause_count; /* array contains histogram of bad clause counts */
 bad_clause_count_str_ptr reset_bad_clause_count; 
 				/* array contains histogram of bad clause counts */
@@ -43,6 +39,14 @@ int * clause_index_to_num;	/* array mapping clause indexes to clause numbers,
 
 int * clause_num_to_index = NULL;	/* array mapping clause numbers to clause indexes,
 					   where indexes correspond to wff[] indexes */
+
+int * false_clause;		/* false_clause[1..num_false_clauses] are the wff[] */
+				/* indexes of the unsatisfied clauses (not */
+				/* maintained with the color option, or by */
+				/* the specialized flip loops) */
+int * false_clause_pos;		/* indexed by wff[] index: position in false_clause, */
+				/* 0 = clause is satisfied */
+int num_false_clauses;
 
 /****************************/
 /*  Current State           */
@@ -157,6 +161,22 @@ int
 int
   flag_superlinear;
 
+int
+  flag_pages;			/* != 0 back wff and assign with huge pages */
+
+long
+  page_size_obtained;		/* page size actually backing wff and assign */
+
+int
+  flag_reorder;			/* != 0 renumber vars and clauses for locality, see reorder.h */
+
+int
+  flip_loop;			/* SPEC_CONFIG of the specialized flip loop in use, */
+				/* -1 = generic, see flip_template.h */
+
+volatile sig_atomic_t
+  signals_pending;		/* 1 = a signal handler left work for service_signals */
+
 char *flag_trace_names[] = {
     "flips", "flip_clauses", "diffs", "makes", "walks", "anneal", "clauses", "tries", "best", "tabu",
     "orphans", "assign", "clause_state"};
@@ -182,7 +202,24 @@ int
   flag_weigh_clauses,		/* 1 = use the clause weights in calculating the diffs */
   flag_coloring,		/* != 0 assume "implicit" k-coloring clauses */
   flag_trace,			/* Each bit specifies feature to trace */
-  flag_anneal;			/* 1 = perform simulated annealing */
+  flag_anneal,			/* 1 = perform simulated annealing */
+  flag_paws,			/* 1 = increase weights of false clauses at local minima */
+  flag_novelty,			/* 1 = pick by Novelty from a random false clause */
+  flag_ccanr,			/* 1 = pick by configuration checking (CCAnr) */
+  flag_probsat,			/* 1 = pick by probSAT from a random false clause */
+  flag_tempering,		/* 1 = anneal replicas at a ladder of temperatures */
+  flag_population,		/* 1 = start tries by crossover of a pool of elites */
+  flag_elite,			/* 1 = share the best assignment among worker processes */
+  flag_coordinate,		/* 1 = coordinate gsat workers over sockets */
+  flag_worker,			/* 1 = work for a coordinator over a socket */
+  flag_pb,			/* 1 = also search over pseudo-Boolean rows */
+  flag_stream,			/* 1 = append stats records to a stream file */
+  flag_record,			/* 1 = record every flip to a binary file */
+  flag_phases,			/* 1 = time phases of the run, for the report */
+  flag_progress,		/* 1 = keep live progress in shared memory */
+  flag_rtd,			/* 1 = make independent runs for a run-length distribution */
+  flag_checkpoint,		/* 1 = write checkpoints to a file */
+  flag_resume;			/* 1 = go on from a checkpoint */
 
 int
   flag_graphics;		/* 1 = call graphics routines after each flip */
@@ -22,6 +22,24 @@
 
 #include "gsat.h"
 #include "anneal.h"
+#include "reorder.h"
+#include "score.h"
+#include "paws.h"
+#include "novelty.h"
+#include "ccanr.h"
+#include "probsat.h"
+#include "tempering.h"
+#include "population.h"
+#include "pb.h"
+#include "ampl.h"
+#include "stream.h"
+#include "record.h"
+#include "phase.h"
+#include "progress.h"
+#include "rtd.h"
+#include "checkpoint.h"
+#include "elite.h"
+#include "cluster.h"
 #include "utils.h"
 #include "adjust_bucket.h"
 
@@ -31,6 +49,12 @@
 #define NO_USLEEP
 #endif
 
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+EXTERN_FUNCTION( int getpagesize, (void) );
+
 #ifdef XGSAT
 #include "xgsat.h"
 #endif
@@ -42,6 +66,7 @@
 EXTERN_FUNCTION (void flip_var, (int var));
 EXTERN_FUNCTION (void propagate_from, (int var));
 EXTERN_FUNCTION (void main_wrapup, (char * msg));
+EXTERN_FUNCTION (void big_flip, ());
 
 
 /**************************/
@@ -152,6 +177,23 @@ parse_parameters()
     flag_walk = 0;
     flag_walk_all_vars = 0;
     flag_anneal = 0;
+    flag_paws = 0;
+    flag_novelty = 0;
+    flag_ccanr = 0;
+    flag_probsat = 0;
+    flag_tempering = 0;
+    flag_population = 0;
+    flag_elite = 0;
+    flag_coordinate = 0;
+    flag_worker = 0;
+    flag_pb = 0;
+    flag_stream = 0;
+    flag_record = 0;
+    flag_phases = 0;
+    flag_progress = 0;
+    flag_rtd = 0;
+    flag_checkpoint = 0;
+    flag_resume = 0;
     flag_adaptive = 0;
     flag_only_unsat = 0;
     reset_weight_tries = 1;
@@ -163,6 +205,8 @@ parse_parameters()
     odds_true = INT_PROB_BASE / 2;
     flag_manual_pick = 0;
     flag_bigflip = 0;
+    flag_pages = 0;
+    flag_reorder = 0;
     seed1 = 0;
     seed2 = 0;
     rand_method = 1;
@@ -174,7 +218,7 @@ parse_parameters()
     /* Get and print optional parameters */
     while (1) {
 	printf("option (? for help): ");
-	if (gets(inputline)==NULL) break;
+	if (flag_worker ? !cluster_get_line(inputline) : gets(inputline)==NULL) break;
 	if (sscanf(inputline, " %s", word1)!=1) break;
 
 	if (strcmp(word1,"?")==0) {
@@ -187,8 +231,17 @@ parse_parameters()
 	    printf("  bigflip = flip all vars in unsatisfied clauses\n");
 	    printf("  bucket = same as hillclimb option below\n");
 	    printf("  c FILE = convert input wff and save as FILE\n");
+	    printf("  ccanr [G [R]] = configuration checking search with clause weights, smoothed\n");
+	    printf("      by factor R (default 0.3) when the average weight exceeds G; implies weight\n");
+	    printf("  checkpoint FILE [SECS] = write the state to FILE every SECS seconds\n");
+	    printf("      (default 300, 0 = never), on SIGUSR2 and SIGTERM, and at the end\n");
 	    printf("  color K = assume implicit clauses for a K-coloring\n");
+	    printf("  coordinate ADDRESS N [FILE] = deal out the option profiles of FILE and\n");
+	    printf("      seeds to N workers at ADDRESS (PORT, HOST:PORT or a socket path),\n");
+	    printf("      and report their combined results\n");
 	    printf("  d = downward moves only\n");
+	    printf("  elite N [M] = run N processes sharing their best assignment; with M,\n");
+	    printf("      start each try from it with M random flips\n");
 	    printf("  f = input wff MUST be f-format, error otherwise\n");
 	    printf("  fix = use fixed random initialization for each random reset\n");
 	    printf("  hillclimb = perform hillclimbing rather than pure greedy search\n");
@@ -198,21 +251,50 @@ parse_parameters()
 	    printf("  m = find multiple assigns\n");
 	    printf("  mail = send email with error messages\n");
 	    printf("  mask N = use N as mask on random values for 0/1 flips\n");
+	    printf("  novelty [P|adaptive [WP]] = flip a var of a random false clause by Novelty\n");
+	    printf("      with noise P (default 0.5), or adaptive noise; WP > 0 gives Novelty+\n");
 	    printf("  only_unsat = greedy flips only choose among vars from unsat clauses\n");
 	    printf("  partial = randomly assign vars not included in init file\n");
+	    printf("  pb FILE [offset] = also satisfy the linear 0-1 rows of FILE, in the format\n");
+	    printf("      of ampl2eqn; offset if the vars of FILE are numbered from 0\n");
+	    printf("  phases [counters] = report the wall time of each phase of the run, and with\n");
+	    printf("      counters its cycles, instructions, cache and branch misses (Linux)\n");
+	    printf("  progress [ADDRESS] = keep live progress in shared memory, served as JSON\n");
+	    printf("      over HTTP at PORT, HOST:PORT or a Unix socket path; SIGUSR1 always\n");
+	    printf("      writes a progress snapshot to stderr\n");
+	    printf("  population [P [K [D]]] = keep the best assignments of up to P tries\n");
+	    printf("      (default 10) and start each try by crossover of K of them (default 3);\n");
+	    printf("      tries closer than D vars (default nvars/100) compete for one slot\n");
 	    printf("  positive F = probability that var inits to true is F (default 0.5)\n");
 	    printf("  plateau N = explore plateau with N unsat clauses by choosing sideways moves only\n");
 	    printf("  hole [continue] = stop after finding first downward move from plateau\n");
 	    printf("      keyword 'continue' means reset number of flips and continue plateau search\n");
 	    printf("  p = init with unit propagation\n");
+	    printf("  pages huge|thp = back wff and variable arrays with huge pages;\n");
+	    printf("      'huge' tries MAP_HUGETLB first, 'thp' only advises transparent huge pages\n");
 	    printf("  pause M = pause M seconds between flips (may be a decimal number)\n");
+	    printf("  paws [N [F]] = raise weights of false clauses at each local minimum,\n");
+	    printf("      smoothing every N raises (default 10); take sideways moves at flat\n");
+	    printf("      minima with probability F (default 0.15); implies weight\n");
+	    printf("  probsat [CB [poly|exp]] = flip a var of a random false clause with probability\n");
+	    printf("      (1+break)^-CB (poly, default 2.38) or CB^-break (exp, default 2.5)\n");
 	    printf("  r N = random reset after N tries (default = 1)\n");
 	    printf("  rand N = use random method number N (default = 1)\n");
+	    printf("  reorder [bfs|cm|rcm] = renumber vars and clauses for memory locality\n");
+	    printf("      (default cm = Cuthill-McKee); output still uses the input names\n");
+	    printf("  record FILE = record every flip to FILE in binary, for flipstat to read\n");
 	    printf("  report N = print report after every N tries (default = 1000)\n");
+	    printf("  rtd R [P] = make R independent runs, P at a time (default: the processors),\n");
+	    printf("      and report the distribution of their flips and seconds to a solution\n");
+	    printf("  resume FILE = go on from the checkpoint in FILE, with the same wff and options\n");
 	    printf("  s = sideways and downwards moves only\n");
 	    printf("  super = superlinear schedule of max-flips\n");
 	    printf("  tabu N = use tabu list of length N\n");
+	    printf("  tempering FILE [K] = anneal one process per line \"STEPS TEMP\" of FILE,\n");
+	    printf("      exchanging temperatures every K flips (default nvars)\n");
 	    printf("  seed N [M] = use N (and optionally M) as the random seed\n");
+	    printf("  stream FILE [json|binary] = append a record per try and per report to FILE\n");
+	    printf("      as JSON lines (default) or binary, instead of try statistics in the report\n");
 	    printf("  trace FLAG = trace also: 1=flips + 2=flip_clauses + 4=diffs + 8=makes +\n");
 	    printf("               16=walks + 32=anneal + 64=clauses + 128=tries + 256=best +\n");
 	    printf("               512=tabu + 1024=orphans + 2048=assign + 4096=clause_state\n");
@@ -222,6 +304,8 @@ parse_parameters()
 	    printf("      F < 0 means random walk even when max_diff>0\n");
 	    printf("      keyword 'all' means randomly pick from all variables,\n");
 	    printf("      otherwise only pick variables with postive make\n");
+	    printf("  worker ADDRESS [SECS] = take the remaining options from the coordinator\n");
+	    printf("      at ADDRESS, sending it a heartbeat every SECS seconds (default 1)\n");
 	    printf("  weight [N] [M] = use clause weights when selecting variable to flip\n");
 	    printf("      resetting weights every N tries (default 1 means reset each assign)\n");
 	    printf("      updating weights by M after each failure (default 1)\n");
@@ -310,6 +394,18 @@ parse_parameters()
 	else if (strcmp(word1,"long")==0) {
 	    printf(" option: print long report\n");
 	    flag_long_report = 1; }
+	else if (sscanf(inputline, " pages %s", word2)==1) {
+	    if (strcmp(word2, "huge")==0)
+	      flag_pages = FLAG_PAGES_HUGE;
+	    else if (strcmp(word2, "thp")==0)
+	      flag_pages = FLAG_PAGES_THP;
+	    else if (strcmp(word2, "default")==0)
+	      flag_pages = 0;
+	    else {
+		sprintf(ss, " ERROR: unknown page policy %s\n", word2);
+		crash_maybe(ss);
+	    }
+	    printf(" option: pages = %s\n", word2); }
 	else if (strcmp(word1,"partial")==0) {
 	    printf(" option: partial init file\n");
 	    flag_partial = 1; }
@@ -317,6 +413,42 @@ parse_parameters()
 	    printf(" option: init file %s\n", init_file);
 	else if (strcmp(word1,"anneal")==0) {
 	    flag_anneal = anneal_parse_parameters(inputline); }
+	else if (strcmp(word1,"paws")==0) {
+	    flag_paws = paws_parse_parameters(inputline);
+	    flag_weigh_clauses = 1; }
+	else if (strcmp(word1,"novelty")==0) {
+	    flag_novelty = novelty_parse_parameters(inputline); }
+	else if (strcmp(word1,"ccanr")==0) {
+	    flag_ccanr = ccanr_parse_parameters(inputline);
+	    flag_weigh_clauses = 1; }
+	else if (strcmp(word1,"probsat")==0) {
+	    flag_probsat = probsat_parse_parameters(inputline); }
+	else if (strcmp(word1,"tempering")==0) {
+	    flag_tempering = tempering_parse_parameters(inputline); }
+	else if (strcmp(word1,"population")==0) {
+	    flag_population = population_parse_parameters(inputline); }
+	else if (strcmp(word1,"elite")==0) {
+	    flag_elite = elite_parse_parameters(inputline); }
+	else if (strcmp(word1,"coordinate")==0) {
+	    flag_coordinate = cluster_coordinate_parse(inputline); }
+	else if (strcmp(word1,"pb")==0) {
+	    flag_pb = pb_parse_parameters(inputline); }
+	else if (strcmp(word1,"stream")==0) {
+	    flag_stream = stream_parse_parameters(inputline); }
+	else if (strcmp(word1,"record")==0) {
+	    flag_record = record_parse_parameters(inputline); }
+	else if (strcmp(word1,"phases")==0) {
+	    flag_phases = phase_parse_parameters(inputline); }
+	else if (strcmp(word1,"progress")==0) {
+	    flag_progress = progress_parse_parameters(inputline); }
+	else if (strcmp(word1,"rtd")==0) {
+	    flag_rtd = rtd_parse_parameters(inputline); }
+	else if (strcmp(word1,"checkpoint")==0) {
+	    flag_checkpoint = checkpoint_parse_parameters(inputline); }
+	else if (strcmp(word1,"resume")==0) {
+	    flag_resume = resume_parse_parameters(inputline); }
+	else if (strcmp(word1,"worker")==0 && !flag_worker) {
+	    flag_worker = cluster_worker_parse(inputline); }
 	else if (sscanf(inputline, " adaptive %d", &flag_adaptive)==1) {
 	    printf(" option: adaptive initialize with %d modifications\n", flag_adaptive); }
 	else if (sscanf(inputline, " plateau %i", &flag_plateau)==1) {
@@ -353,6 +485,8 @@ parse_parameters()
 
 	else if (sscanf(inputline, " r %d", &reset_tries)==1) {
 	    printf(" option: reset_tries = %d\n", reset_tries); }
+	else if (strcmp(word1,"reorder")==0) {
+	    flag_reorder = reorder_parse_parameters(inputline); }
 	else if (sscanf(inputline, " report %d", &report_interval)==1) {
 	    printf(" option: report_interval = %d\n", report_interval); }
 	else if (sscanf(inputline, " seed %d %d", &seed1, &seed2)==2) {
@@ -684,6 +818,7 @@ print_try_statistics()  /* print stats on most recent try */
 	       current_max_diff, current_num_bad, low_bad, downwards_count,
 	       sideways_count, upwards_count, null_count);
     }
+    if (flag_stream) return;	/* the stream has them */
     fprintf(try_stat_filep, "TRY %d: init_bad=%d, max_flips=%d, max_diff=%d, num_bad=%d, low_bad=%d, d=%d s=%d u=%d n=%d\n",
 	    current_try, init_bad, max_flips,
 	    current_max_diff, current_num_bad, low_bad, downwards_count,
@@ -773,10 +908,10 @@ PARAMS(FILE *fp_report;)
     n = total_sum_tries;
     
     for (i = 1; i <= nvars; i++) {
-	c = assign[i].positive_count;
+	c = assign[internal_var(i)].positive_count;
 	a = ((double)c)/n;
 	fprintf(fp_report, "  %6d    %6d    %6d    %6d\n", 
-		i, c, ((int)(100*a)), assign[i].flip_count);
+		i, c, ((int)(100*a)), assign[internal_var(i)].flip_count);
     }
     fprintf (fp_report,"End of variable statistics\n\n");
 }
@@ -796,7 +931,7 @@ PARAMS(FILE *fp_report;)
 	    fprintf(fp_report, " %6d    x %6d    ", i, wff[clause_index].next);
 	    clause_len = wff[clause_index].lit;
 	    for (j=1; j<=clause_len; j++){
-		fprintf(fp_report, " %d ", wff[clause_index + j].lit);
+		fprintf(fp_report, " %d ", external_lit(wff[clause_index + j].lit));
 	    }
 	    fprintf(fp_report, "\n");
 	}
@@ -814,8 +949,8 @@ PARAMS(FILE *fp;)
     fprintf(fp,"Positive literals in best model:\n");
     k=1;
     for (i = 1; i <= nvars; i++) {
-	if (assign[i].value_best == 1){
-	    fprintf(fp," %d ", (i * assign[i].value_best));
+	if (assign[internal_var(i)].value_best == 1){
+	    fprintf(fp," %d ", i);
 	    k++;
 	    if ((k%LINE_LENGTH) == 0) fprintf(fp,"\n ");
 	}
@@ -853,7 +988,7 @@ PARAMS(FILE *fp;)
 		}
 		if (bad) {
 		    for (j=1; j<=clause_len; j++){
-			lit = wff[clause_index + j].lit;
+			lit = external_lit(wff[clause_index + j].lit);
 			if (lit<0)
 			  lit -= offset;
 			else
@@ -897,6 +1032,7 @@ PARAMS( char * message;)
     fprintf(fp_report, "nvars (number of variables): %d\n", nvars);
     fprintf(fp_report, "nclauses (number of clauses): %d\n", nclauses);
     fprintf(fp_report, "nlits (length of wff): %d\n", nlits);
+    fprintf(fp_report, "page_size: %ld\n", page_size_obtained);
 
     fprintf(fp_report, "assign_file: %s\n", assign_file);  
     fprintf(fp_report, "report_file: %s\n", report_file);
@@ -935,7 +1071,27 @@ PARAMS( char * message;)
 	fprintf(fp_report, "weight_update_amt: %d\n", weight_update_amt);
     }
     if (flag_anneal) fprintf(fp_report, "flag_anneal: %d\n", flag_anneal);
+    if (flag_paws) paws_print_report(fp_report);
+    if (flag_novelty) novelty_print_report(fp_report);
+    if (flag_ccanr) ccanr_print_report(fp_report);
+    if (flag_probsat) probsat_print_report(fp_report);
+    if (flag_tempering) tempering_print_report(fp_report);
+    if (flag_population) population_print_report(fp_report);
+    if (flag_elite) elite_print_report(fp_report);
+    if (flag_coordinate || flag_worker) cluster_print_report(fp_report);
+    if (flag_pb) pb_print_report(fp_report);
+    if (flag_stream) stream_print_report(fp_report);
+    if (flag_record) record_print_report(fp_report);
+    if (flag_phases) fprintf(fp_report, "flag_phases: %d\n", flag_phases);
+    if (flag_progress) progress_print_report(fp_report);
+    if (flag_checkpoint || flag_resume) checkpoint_print_report(fp_report);
     if (flag_bigflip) fprintf(fp_report, "flag_bigflip: %d\n", flag_bigflip);
+    if (flag_pages) fprintf(fp_report, "flag_pages: %d\n", flag_pages);
+    if (flag_reorder) reorder_print_report(fp_report);
+    if (flip_loop >= 0)
+      fprintf(fp_report, "flip_loop: specialized %d\n", flip_loop);
+    else
+      fprintf(fp_report, "flip_loop: generic\n");
     if (flag_save_best_max!=SAVE_BEST_MAX_DEFAULT) fprintf(fp_report, "flag_save_best_max: %d\n", flag_save_best_max);
     if (flag_adaptive) fprintf(fp_report, "flag_adaptive: %d\n", flag_adaptive);
     if (tabu_list_length) fprintf(fp_report, "tabu_list_length: %d\n", tabu_list_length);
@@ -960,6 +1116,7 @@ PARAMS( char * message;)
     fprintf(fp_report, "assigns_per_second: %f\n", total_num_assigns / experiment_seconds);
     fprintf(fp_report, "flips_per_second: %f\n", total_sum_flips / experiment_seconds);
     fprintf(fp_report, "tries_per_second: %f\n", total_sum_tries / experiment_seconds);
+    if (flag_phases) phase_print_report(fp_report);
     fprintf(fp_report, "assignments_per_try: %f\n", 
 	    (float)total_num_assigns / total_sum_tries);
     fprintf(fp_report, "successful_flips_per_flip (ratio productive effort): %f\n", 
@@ -1005,6 +1162,7 @@ PARAMS( char * message;)
 	    ((best_reset_count-1)*max_flips)+best_flip);
 
     if (flag_anneal) anneal_print_report(fp_report);
+    if (flag_rtd) rtd_print_report(fp_report);
 
     print_positive_literals(fp_report);
 
@@ -1015,6 +1173,7 @@ PARAMS( char * message;)
     }
 
     fprintf(fp_report, "\nTRY STATISTICS:\n");
+    if (flag_stream) fprintf(fp_report, "In the stream file\n");
 
     fflush(try_stat_filep);
     rewind(try_stat_filep);
@@ -1056,8 +1215,8 @@ print_assignment_file()
     fprintf (fp,"(setq *gsat-model-list* '( \n ");
     k=1;
     for (i = 1; i <= nvars; i++) {
-	if (assign[i].value_best == 1){
-	    fprintf(fp," %d ", (i * assign[i].value_best));
+	if (assign[internal_var(i)].value_best == 1){
+	    fprintf(fp," %d ", i);
 	    k++;
 	    if ((k%LINE_LENGTH) == 0) fprintf(fp,"\n ");
 	}
@@ -1067,7 +1226,7 @@ print_assignment_file()
     fprintf(fp,";;; Model vector; first element not used\n");
     fprintf (fp,"(setq *current-propositional-model* (vector 0 \n ");
     for (i = 1; i <= nvars; i++) {
-	if (assign[i].value_best > 0) fprintf(fp," 1 ");
+	if (assign[internal_var(i)].value_best > 0) fprintf(fp," 1 ");
 	else fprintf(fp, " 0 ");
 	if ((i%LINE_LENGTH) == 0) fprintf(fp,"\n ");
     }
@@ -1084,7 +1243,7 @@ print_assign_stdout()
     printf("Positive literals:");
     k = 0;
     for (i = 1; i <= nvars; i++) {
-	if (assign[i].value == 1){
+	if (assign[internal_var(i)].value == 1){
 	    printf(" %d ", i);
 	    k++;
 	    /* if ((k%LINE_LENGTH) == 0) printf("\n"); */
@@ -1120,6 +1279,8 @@ PARAMS(int sig; int code; struct sigcontext * scp; char * addr;)
     sigsetmask(0);
 #endif
 
+    if (flag_checkpoint && sig == SIGTERM) checkpoint_request(1);
+
     if (flag_abort == 0) {
 	printf("\n\nShhh!\n");
 	flag_abort = -1;
@@ -1129,13 +1290,16 @@ PARAMS(int sig; int code; struct sigcontext * scp; char * addr;)
 	experiment_seconds += elapsed_seconds();
 	flag_abort = 1;
 	print_report("KEYBOARD INTERRUPT");
+	if (flag_stream) stream_report("KEYBOARD INTERRUPT");
 	elapsed_seconds();
 	printf("\nReport printed -- keep going? [y or n] ");
+	fflush(stdout);
 	if (gets(inputline)==NULL){
 	    inputline[0]='n';
 	}
 	while (((c=inputline[0])!='y') && c != 'n' && c != EOF && c != '\003' ){
 	    printf("\nType 'y' or 'n' followed by return: ");
+	    fflush(stdout);
 	    if (gets(inputline)==NULL){
 		inputline[0]='n';
 	    }
@@ -1157,6 +1321,17 @@ PARAMS(int sig; int code; struct sigcontext * scp; char * addr;)
     signal(SIGTERM, handle_interrupt);
 }
      
+void
+service_signals()
+     /* Do what the signal handlers have left for a safe point: the flip
+	loop and the try loop call this between flips and between tries */
+{
+    signals_pending = 0;
+    if (flag_worker) cluster_service();
+    progress_service();
+    if (flag_checkpoint) checkpoint_service();
+}
+     
 /**************************/
 /*  Converting Wff Format */
 /**************************/
@@ -1238,6 +1413,9 @@ void
 output_converted_wff()
 {
     FILE *fp;
+
+    if (flag_format == FLAG_FORMAT_NL)
+      crash_and_burn("ERROR: cannot convert the rows of an AMPL file\n");
     if ((fp = fopen(convert_file, "w"))==NULL) {
 	sprintf(ss, "ERROR: cannot open output file %s\n", convert_file);
 	crash_and_burn(ss);
@@ -1445,11 +1623,82 @@ PARAMS(int odds;)
 /*  Initializing    */
 /********************/
 
+#define HUGE_PAGE_SIZE (2L*1024L*1024L) /* x86 and most others; see Hugepagesize in /proc/meminfo */
+
+int
+transparent_huge_pages_enabled()
+     /* Returns 1 iff the kernel has transparent huge pages turned on */
+{
+    FILE * fp;
+    char line[MAXLINE];
+
+    if ((fp = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r")) == NULL)
+      return 0;
+    if (fgets(line, MAXLINE, fp) == NULL) line[0] = 0;
+    fclose(fp);
+    return (strstr(line, "[never]") == NULL && line[0] != 0);
+}
+
+char *
+alloc_formula_array(PROTO(size_t) bytes, PROTO(long *) page_size)
+     /* Allocate one of the big arrays that are randomly accessed on every
+	flip (wff and assign).  With the pages option, try to back it with
+	huge pages to cut TLB misses, and fall back to malloc.
+	Sets *page_size to the page size actually used. */
+PARAMS( size_t bytes; long * page_size; )
+{
+    char * p;
+    char * aligned;
+    size_t len;
+
+    *page_size = getpagesize();
+#if defined(MAP_ANONYMOUS)
+    len = ((bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    if (flag_pages == FLAG_PAGES_HUGE){
+	p = (char *) mmap(NULL, len, PROT_READ | PROT_WRITE,
+			  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (p != (char *) MAP_FAILED){
+	    *page_size = HUGE_PAGE_SIZE;
+	    return p;
+	}
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    if (flag_pages){
+	/* Over-allocate by one huge page so the array can start on a huge
+	   page boundary, then give back the ragged ends. */
+	p = (char *) mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+			  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p != (char *) MAP_FAILED){
+	    aligned = (char *)((((unsigned long) p) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+	    if (aligned > p) munmap(p, aligned - p);
+	    if (aligned + len < p + len + HUGE_PAGE_SIZE)
+	      munmap(aligned + len, (p + len + HUGE_PAGE_SIZE) - (aligned + len));
+	    if (madvise(aligned, len, MADV_HUGEPAGE) == 0 && transparent_huge_pages_enabled())
+	      *page_size = HUGE_PAGE_SIZE;
+	    return aligned;
+	}
+    }
+#endif
+#endif
+    if (flag_pages)
+      printf("Warning!  Huge pages not available, using ordinary pages\n");
+    return (char *) malloc(bytes);
+}
+
 void
 allocate_memory()
 {
-    wff = (wff_str_ptr) malloc ((size_t)((nlits + nclauses + 1) * (sizeof(struct wff_str))));
-    assign = (var_str_ptr) malloc ((size_t)(nvars + 1) * (sizeof(struct var_str)));
+    long wff_page_size, assign_page_size;
+
+    wff = (wff_str_ptr) alloc_formula_array((size_t)((nlits + nclauses + 1) * (sizeof(struct wff_str))),
+					    &wff_page_size);
+    assign = (var_str_ptr) alloc_formula_array((size_t)(nvars + 1) * (sizeof(struct var_str)),
+					       &assign_page_size);
+    /* Report the smaller of the two, i.e. the page size we can count on */
+    page_size_obtained = (wff_page_size < assign_page_size) ? wff_page_size : assign_page_size;
+    if (flag_pages) printf("page_size = %ld\n", page_size_obtained);
     bad_clause_count = (bad_clause_count_str_ptr) 
       malloc ((size_t)((LENGTH_BAD_CLAUSE_COUNT + 1)* 
 	      (sizeof(struct bad_clause_count_str))));
@@ -1968,6 +2217,8 @@ read_in()
 	  flag_format = FLAG_FORMAT_KF;
 	else if (0==strcmp(".cnf", &(wff_file[strlen(wff_file)-4])))
 	  flag_format = FLAG_FORMAT_CNF;
+	else if (0==strcmp(".nl", &(wff_file[strlen(wff_file)-3])))
+	  flag_format = FLAG_FORMAT_NL;
     }
     
     switch (flag_format){
@@ -1980,6 +2231,9 @@ read_in()
       case FLAG_FORMAT_CNF:
 	read_in_cnf_format() ||  crash_and_burn("Bad input file!\n");
 	break;
+      case FLAG_FORMAT_NL:
+	read_in_nl_format() ||  crash_and_burn("Bad input file!\n");
+	break;
       case FLAG_FORMAT_F:
 	read_in_f_lisp_format() ||  
 	  read_in_f_format() ||  
@@ -2009,10 +2263,8 @@ clear_out_lists()
 	var_ptr->down.pos = 0;
 	var_ptr->sideways.list = 0;
 	var_ptr->sideways.pos = 0;
-	var_ptr->maxdiff.list = 0;
-	var_ptr->maxdiff.pos = 0;
-	var_ptr->tabu.list = 0;
-	var_ptr->tabu.pos = 0;
+	var_ptr->score = 0;
+	var_ptr->score_pos = 0;
 	var_ptr->walk.list = 0;
 	var_ptr->walk.pos = 0;
 	var_ptr->free.list = 0;
@@ -2064,6 +2316,12 @@ init_pointers()
 	clause_index += len_clause + 1;
     }
 
+    /* The list of unsatisfied clauses is filled in by init_diff */
+    false_clause = (int *) malloc((size_t)((nclauses + 1) * (sizeof(int))));
+    false_clause_pos = (int *) malloc((size_t)((nlits + nclauses + 1) * (sizeof(int))));
+    for (i=0; i <= nlits + nclauses; i++) false_clause_pos[i] = 0;
+    num_false_clauses = 0;
+
     /* Allocate and initialize clause_index_to_num, but only if it is needed */
     if ((flag_trace & FLAG_TRACE_CLAUSE_STATE)||flag_graphics){
 	clause_index_to_num = (int *) malloc((size_t)((nlits + nclauses + 1) * (sizeof(int))));
@@ -2130,6 +2388,7 @@ read_initial_assign()
 	    sprintf(ss, "Bad init file %s\n", init_file);
 	    crash_and_burn(ss);
 	}
+	lit = internal_lit(lit);
 	if (lit<0) assign[-lit].value= -1;
 	else assign[lit].value =1;
 	if (flag_graphics) graphics_show_variable(abs(lit), 0);
@@ -2275,6 +2534,11 @@ init_assign_values()
 
     clear_out_lists();
 
+    if (flag_population && population_init_values())
+      return;
+    if (flag_elite && elite_init_values())
+      return;
+
     /*  every reset_tries steps completely randomize  */ 
     if ( (try_this_assign - 1) % reset_tries == 0){
 	if (init_file[0])
@@ -2333,69 +2597,63 @@ init_assign_values()
 
 void
 init_tabu()
+     /* No var is tabu at the start of a try */
 {
-    tabu_in = 0;
-    tabu_out = 0;
-}
+    int i;
+    var_str_ptr var_ptr;
 
-void
-rotate_tabu_list( PROTO(int) var )
-PARAMS( int var; )
-{
-    var_str_ptr varptr;
-    int outvar;
-
-    /* Put var into tabu list, and remove oldest member from tabu list.  */
-    if (tabu_list_length > 0){
-	if (flip > tabu_list_length){
-	    if (++tabu_out > tabu_list_length)
-	      tabu_out = 1;
-	    outvar = assign[tabu_out].tabu.list;
-	    CHECK({
-		if (outvar < 1 || outvar > nvars){
-		    sprintf(ss, "Bad variable %d appears in tabu list position %d\n",
-			    outvar, tabu_out);
-		    crash_and_burn(ss);
-		}
-	    });
-	    varptr = &assign[outvar];
-	    varptr->tabu.pos = 0;
-	    adjust_bucket(varptr);
-	}
-	if (++tabu_in > tabu_list_length)
-	  tabu_in = 1;
-	assign[tabu_in].tabu.list = var;
-	varptr = &assign[var];
-	varptr->tabu.pos = tabu_in;
-	if (flag_hillclimb){
-	    delete_if_in(up, varptr);
-	    delete_if_in(down, varptr);
-	    delete_if_in(sideways, varptr);
-	}
-	else {
-	    delete_if_in(maxdiff, varptr);
-	}
-	delete_if_in(walk, varptr);
-    }
+    for (i = 0, var_ptr=assign; i <= nvars; i++, var_ptr++)
+      var_ptr->last_flip = -tabu_list_length - 1;
 }
 
 void
 print_tabu_list()
 {
-  int len, i, j;
+  int i;
 
-  len = (flip < tabu_list_length) ? flip : tabu_list_length;
   printf("Tabu list: ");
-
-  j = tabu_out;
-  for (i=1; i<=len; i++){
-      if (++j > tabu_list_length)
-	j = 1;
-      printf(" %d ", assign[j].tabu.list);
+  for (i=1; i<=nvars; i++){
+      if (is_tabu(&assign[i]))
+	printf(" %d ", i);
   }
   printf("\n");
 }
 
+/* Define allowed_member_KEY(pick), for the indexed list KEY.  If pick
+   is 0, return nonzero iff some member of the list is not tabu;
+   otherwise return a random member that is not tabu, or 0 if there is
+   none.  At most tabu_list_length vars are tabu, so a longer list
+   always has an allowed member, and random probes nearly always find
+   one. */
+#define DEFINE_ALLOWED_MEMBER(KEY) \
+int \
+allowed_member_##KEY(PROTO(int) pick) \
+PARAMS(int pick;) \
+{ \
+    int i, n, var; \
+\
+    if (length_of(KEY) > tabu_list_length){ \
+	if (!pick) return 1; \
+	for (i = 1; i <= TABU_PICK_TRIES; i++){ \
+	    var = random_member(KEY); \
+	    if (!is_tabu(&assign[var])) return var; \
+	} \
+    } \
+    n = 0; \
+    for (i = 1; i <= length_of(KEY); i++) \
+      if (!is_tabu(&assign[assign[i].KEY.list])) n++; \
+    if (n == 0 || !pick) return n; \
+    n = random_1_to(n); \
+    for (i = 1; ; i++) \
+      if (!is_tabu(&assign[assign[i].KEY.list]) && --n == 0) \
+	return assign[i].KEY.list; \
+}
+
+DEFINE_ALLOWED_MEMBER(up)
+DEFINE_ALLOWED_MEMBER(down)
+DEFINE_ALLOWED_MEMBER(sideways)
+DEFINE_ALLOWED_MEMBER(walk)
+
 
 /*************************************/
 /*  Flipping and Calculating Diffs   */
@@ -2404,19 +2662,6 @@ print_tabu_list()
 #define SCALED_WEIGHT  (flag_weigh_clauses ? weight : 1)
 
 
-int
-pick_greedy_var()
-{
-    if (flag_hillclimb){
-	return length_of(down) ? random_member(down) 
-	  : ( length_of(sideways) ? random_member(sideways)
-	     : random_member(up) );
-    }
-    else {
-	return random_member(maxdiff);
-    }
-}
-
 int
 plateau_pick_var()
 {
@@ -2451,105 +2696,36 @@ plateau_pick_var()
 	for (i=1; i<=length_of(down); i++)
 	  printf("Hole: %d\n", assign[i].down.list);
     }
-    if (length_of(sideways)) 
-      return random_member(sideways);
-    else
-      return 0;
-}
-
-int 
-pick_rand_var() 
-{
-    int var, i;
-
-    if (flag_trace & FLAG_TRACE_DIFFS){
-	if (flag_hillclimb){
-	    print_list(down, diff, "DOWN: Vars with diff>0 : ");
-	    print_list(sideways, diff, "SIDEWAYS: Vars with diff=0 : ");
-	    print_list(up, diff, "UP: Vars with diff<0 : ");
-	}
-	else {
-	    print_list(maxdiff, diff, "MAXDIFF: Vars with max diff: ");
-	}
-    }
-    if (flag_trace & FLAG_TRACE_MAKES)
-      print_list(walk, make, "WALK: Vars with make>0 : ");
-    if (flag_trace & FLAG_TRACE_TABU)
-      print_tabu_list();
-
-    if (flag_manual_pick){
-	printf(">>>> For flip %d, I should pick : ", flip + 1);
-	scanf("%d", &var);
-	if (var) return var;
-    }
-
-    if (flag_anneal)
-      return (anneal_pick_var());
-
-    if ((flag_plateau) && (flag_plateau >= current_num_bad)) 
-      return plateau_pick_var();
-      
-    if (flag_walk){
-	if ((flag_walk < 0 && random_01_odds(-flag_walk))
-	    ||
-	    (flag_walk > 0 && current_max_diff <= 0 && random_01_odds(flag_walk))){
-	    if (flag_walk_all_vars || length_of(walk) == 0)
-	      var = random_1_to(nvars);
-	    else
-	      var = random_member(walk);
-	    if (flag_trace & FLAG_TRACE_WALKS)
-	      printf("Walk var=%d, diff=%d, make=%d\n", var, assign[var].diff, assign[var].make);
-	    return var;
-	}
-    }
-
-    return pick_greedy_var();
+    return allowed_member_sideways(1);
 }
 
-
 void
 init_buckets()
 {
     var_str_ptr varptr;
     int i;
-    int md, bl;
 
     if (flag_hillclimb){
 	for (i=1, varptr = &assign[1]; i<=nvars; i++, varptr++){
 	    /* vars that appear in no clause should never be flipped,
 	       so don't put them in any bucket */
-	    if (!is_in(tabu, varptr) && 
-		(!flag_only_unsat || varptr->make > 0) &&
-		(varptr->first != -1 || flag_coloring)){
+	    if ((!flag_only_unsat || varptr->make > 0) &&
+		(varptr->first != -1 || flag_coloring || (flag_pb && pb_occurs(i)))){
 		adjust_bucket(varptr);
 	    }
 	}
     }
     else {
-	md = -BIG;
-	bl = 0;
+	score_clear();
 	for (i=1, varptr = &assign[1]; i<=nvars; i++, varptr++){
-	    if (!is_in(tabu, varptr) && 
-		(!flag_only_unsat || varptr->make > 0) &&
-		(varptr->first != -1 || flag_coloring)){
-		if (varptr->diff > md){
-		    bl = 1;
-		    assign[1].maxdiff.list = varptr->name;
-		    md = varptr->diff;
-		}
-		else if (varptr->diff == md){
-		    assign[++bl].maxdiff.list = varptr->name;
-		}
+	    if ((!flag_only_unsat || varptr->make > 0) &&
+		(varptr->first != -1 || flag_coloring || (flag_pb && pb_occurs(i)))){
+		score_insert(varptr);
 		if (varptr->make > 0 && !is_in(walk, varptr)){
 		    add_to(walk, varptr);
 		}
 	    }
 	}
-	for (i=1, varptr = &assign[1]; i<=bl; i++, varptr++){
-	    assign[ varptr->maxdiff.list ].maxdiff.pos = i;
-	}
-	assign->maxdiff.list = bl;
-	current_max_diff = md;
     }
 }
 
@@ -2573,6 +2749,10 @@ init_diff()
 
     /* printf("Initializing diff\n"); */
 
+    for (i = 1; i <= num_false_clauses; i++)
+      false_clause_pos[false_clause[i]] = 0;
+    num_false_clauses = 0;
+
     for (offset=0; (offset==0) || (offset < flag_coloring); offset++){
 
 	if (flag_trace & FLAG_TRACE_DIFFS){
@@ -2613,6 +2793,7 @@ init_diff()
 		    assign[pot_crit].diff -= weight;
 		}
 		else if (npos == 0) { /* clause is unsat */
+		    if (!flag_coloring && flip_loop < 0) add_false_clause(clause_index);
 		    inner_clause_ptr = clause_start + 1;
 		    for (j = 1 ; j <= clause_len ; j++) {
 			alit = abs_val(inner_clause_ptr->lit) + offset;
@@ -2627,227 +2808,258 @@ init_diff()
 	    clause_start += clause_len + 1;
 	}
     }
+    if (flag_pb) pb_init_diff();
     if (flag_trace & FLAG_TRACE_CLAUSE_STATE)
       printf("END initial assignment\n");
 }
 
 
-void
-update_diff(PROTO(int) var)
-     /* Update diffs for var, including implicit clauses */
-PARAMS(int var;)
-{
-    wff_str_ptr clause_ptr;
-    wff_str_ptr clause_start;
-    var_str_ptr var_ptr, other_var_ptr, alit_ptr;
-    int i, lit, alit, clause_len, npos, var_makes_clause, next_clause, other_var;
-    int offset;
-    int weight;
-    int this_clause;
-    int notice_clause_state;
-
-    notice_clause_state = (flag_trace & FLAG_TRACE_CLAUSE_STATE)||flag_graphics;
-
-    var_ptr = &assign[var];
-    offset = flag_coloring ? ((var - 1) % flag_coloring) : 0;
-    next_clause = assign[var - offset].first;
-
-    /* printf("Update var=%d offset=%d\n", var, offset); */
-
-    while (next_clause != -1) {
-	
-	clause_len = (clause_ptr = clause_start = &wff[this_clause = next_clause])->lit;
-	weight = flag_weigh_clauses ? clause_ptr->next : 1;
-	clause_ptr++;
-
-	/* printf("Testing clause "); */
-	/* print_clause(next_clause); */
-
-	npos = 0;
-	var_makes_clause = 0;
-	for (i = 1; i <= clause_len; i++) {
-
-	    if ((lit = clause_ptr->lit ) < 0){
-		if ((alit = -lit  + offset)==var){
-		    next_clause = clause_ptr->next;
-		    /* printf("next clause =%d  ", next_clause); */
-		}
-	    }
-	    else {
-		if ((alit = lit)==(var - offset)){
-		    next_clause = clause_ptr->next;
-		    /* printf("next clause =%d  ", next_clause); */
-		}
-	    }
-
-	    /* printf("Alit = %d  ", alit); */
-
-	    if (same_sign((alit_ptr = &assign[alit])->value, lit)){
-		npos ++;
-		if (alit == var) {
-		    var_makes_clause = 1;
-		}
-		else {
-		    other_var = alit;
-		    other_var_ptr = alit_ptr;
-		}
-	    }
-	    clause_ptr++;
-	}
-
-	/* printf(" npos = %d, var_makes_clause = %d, other_var=%d \n", npos, var_makes_clause, other_var);  */
-
-	if ((npos == 1) && !var_makes_clause) {
-	    /* other_var becomes critical */
-	    other_var_ptr->diff -= weight;
-	    adjust_bucket(other_var_ptr);
-	}
-	else if ((npos == 2) && var_makes_clause){
-	    /* other_var becomes uncritical */
-	    other_var_ptr->diff += weight;
-	    adjust_bucket(other_var_ptr);
-	}
-	else if (npos == 0){
-	    /* clause becomes unsat */
-	    if (notice_clause_state)
-	      trace_clause_state(this_clause, -1);
-	    current_num_bad++;
-	    clause_ptr = clause_start + 1;
-	    for (i = 1 ; i <= clause_len ; i++) {
-		if ((lit = clause_ptr->lit)<0)
-		  alit = -lit + offset;
-		else
-		  alit = lit;
-		(alit_ptr = &assign[alit])->diff += weight;
-		alit_ptr->make += weight;
-		if (alit != var) adjust_bucket(alit_ptr);
-		clause_ptr++;
-	    }
-	    var_ptr->diff += weight;
-	}
-	else if (npos == 1) {
-	    /* clause becomes pos; reduce makes; var becomes critical */
-	    if (notice_clause_state)
-	      trace_clause_state(this_clause, 1);
-	    current_num_bad-- ;
-	    clause_ptr = clause_start + 1;
-	    for (i = 1 ; i <= clause_len ; i++) {
-		if ((lit = clause_ptr->lit)<0)
-		  alit = -lit + offset;
-		else
-		  alit = lit;
-		(alit_ptr = &assign[alit])->diff -= weight;
-
-		alit_ptr->make -= weight;
-		if (alit != var) adjust_bucket(alit_ptr);
-		clause_ptr++;
-	    }
-	    var_ptr->diff -= weight;
-	}
-    }
-    adjust_bucket(var_ptr);
-}
-
+/* Generic flip loop, then one specialized copy per configuration */
+#include "flip_template.h"
+
+#define SPEC_CONFIG 0
+#define SPEC(name) name##_0
+#include "flip_template.h"
+#define SPEC_CONFIG 1
+#define SPEC(name) name##_1
+#include "flip_template.h"
+#define SPEC_CONFIG 2
+#define SPEC(name) name##_2
+#include "flip_template.h"
+#define SPEC_CONFIG 3
+#define SPEC(name) name##_3
+#include "flip_template.h"
+#define SPEC_CONFIG 4
+#define SPEC(name) name##_4
+#include "flip_template.h"
+#define SPEC_CONFIG 5
+#define SPEC(name) name##_5
+#include "flip_template.h"
+#define SPEC_CONFIG 6
+#define SPEC(name) name##_6
+#include "flip_template.h"
+#define SPEC_CONFIG 7
+#define SPEC(name) name##_7
+#include "flip_template.h"
+#define SPEC_CONFIG 8
+#define SPEC(name) name##_8
+#include "flip_template.h"
+#define SPEC_CONFIG 9
+#define SPEC(name) name##_9
+#include "flip_template.h"
+#define SPEC_CONFIG 10
+#define SPEC(name) name##_10
+#include "flip_template.h"
+#define SPEC_CONFIG 11
+#define SPEC(name) name##_11
+#include "flip_template.h"
+#define SPEC_CONFIG 12
+#define SPEC(name) name##_12
+#include "flip_template.h"
+#define SPEC_CONFIG 13
+#define SPEC(name) name##_13
+#include "flip_template.h"
+#define SPEC_CONFIG 14
+#define SPEC(name) name##_14
+#include "flip_template.h"
+#define SPEC_CONFIG 15
+#define SPEC(name) name##_15
+#include "flip_template.h"
+#define SPEC_CONFIG 16
+#define SPEC(name) name##_16
+#include "flip_template.h"
+#define SPEC_CONFIG 17
+#define SPEC(name) name##_17
+#include "flip_template.h"
+#define SPEC_CONFIG 18
+#define SPEC(name) name##_18
+#include "flip_template.h"
+#define SPEC_CONFIG 19
+#define SPEC(name) name##_19
+#include "flip_template.h"
+#define SPEC_CONFIG 20
+#define SPEC(name) name##_20
+#include "flip_template.h"
+#define SPEC_CONFIG 21
+#define SPEC(name) name##_21
+#include "flip_template.h"
+#define SPEC_CONFIG 22
+#define SPEC(name) name##_22
+#include "flip_template.h"
+#define SPEC_CONFIG 23
+#define SPEC(name) name##_23
+#include "flip_template.h"
+#define SPEC_CONFIG 24
+#define SPEC(name) name##_24
+#include "flip_template.h"
+#define SPEC_CONFIG 25
+#define SPEC(name) name##_25
+#include "flip_template.h"
+#define SPEC_CONFIG 26
+#define SPEC(name) name##_26
+#include "flip_template.h"
+#define SPEC_CONFIG 27
+#define SPEC(name) name##_27
+#include "flip_template.h"
+#define SPEC_CONFIG 28
+#define SPEC(name) name##_28
+#include "flip_template.h"
+#define SPEC_CONFIG 29
+#define SPEC(name) name##_29
+#include "flip_template.h"
+#define SPEC_CONFIG 30
+#define SPEC(name) name##_30
+#include "flip_template.h"
+#define SPEC_CONFIG 31
+#define SPEC(name) name##_31
+#include "flip_template.h"
+#define SPEC_CONFIG 32
+#define SPEC(name) name##_32
+#include "flip_template.h"
+#define SPEC_CONFIG 33
+#define SPEC(name) name##_33
+#include "flip_template.h"
+#define SPEC_CONFIG 34
+#define SPEC(name) name##_34
+#include "flip_template.h"
+#define SPEC_CONFIG 35
+#define SPEC(name) name##_35
+#include "flip_template.h"
+#define SPEC_CONFIG 36
+#define SPEC(name) name##_36
+#include "flip_template.h"
+#define SPEC_CONFIG 37
+#define SPEC(name) name##_37
+#include "flip_template.h"
+#define SPEC_CONFIG 38
+#define SPEC(name) name##_38
+#include "flip_template.h"
+#define SPEC_CONFIG 39
+#define SPEC(name) name##_39
+#include "flip_template.h"
+#define SPEC_CONFIG 40
+#define SPEC(name) name##_40
+#include "flip_template.h"
+#define SPEC_CONFIG 41
+#define SPEC(name) name##_41
+#include "flip_template.h"
+#define SPEC_CONFIG 42
+#define SPEC(name) name##_42
+#include "flip_template.h"
+#define SPEC_CONFIG 43
+#define SPEC(name) name##_43
+#include "flip_template.h"
+#define SPEC_CONFIG 44
+#define SPEC(name) name##_44
+#include "flip_template.h"
+#define SPEC_CONFIG 45
+#define SPEC(name) name##_45
+#include "flip_template.h"
+#define SPEC_CONFIG 46
+#define SPEC(name) name##_46
+#include "flip_template.h"
+#define SPEC_CONFIG 47
+#define SPEC(name) name##_47
+#include "flip_template.h"
+#define SPEC_CONFIG 48
+#define SPEC(name) name##_48
+#include "flip_template.h"
+#define SPEC_CONFIG 49
+#define SPEC(name) name##_49
+#include "flip_template.h"
+#define SPEC_CONFIG 50
+#define SPEC(name) name##_50
+#include "flip_template.h"
+#define SPEC_CONFIG 51
+#define SPEC(name) name##_51
+#include "flip_template.h"
+#define SPEC_CONFIG 52
+#define SPEC(name) name##_52
+#include "flip_template.h"
+#define SPEC_CONFIG 53
+#define SPEC(name) name##_53
+#include "flip_template.h"
+#define SPEC_CONFIG 54
+#define SPEC(name) name##_54
+#include "flip_template.h"
+#define SPEC_CONFIG 55
+#define SPEC(name) name##_55
+#include "flip_template.h"
+#define SPEC_CONFIG 56
+#define SPEC(name) name##_56
+#include "flip_template.h"
+#define SPEC_CONFIG 57
+#define SPEC(name) name##_57
+#include "flip_template.h"
+#define SPEC_CONFIG 58
+#define SPEC(name) name##_58
+#include "flip_template.h"
+#define SPEC_CONFIG 59
+#define SPEC(name) name##_59
+#include "flip_template.h"
+#define SPEC_CONFIG 60
+#define SPEC(name) name##_60
+#include "flip_template.h"
+#define SPEC_CONFIG 61
+#define SPEC(name) name##_61
+#include "flip_template.h"
+#define SPEC_CONFIG 62
+#define SPEC(name) name##_62
+#include "flip_template.h"
+#define SPEC_CONFIG 63
+#define SPEC(name) name##_63
+#include "flip_template.h"
+
+static void (*try_flips_selected)();
+
+static void (*try_flips_table[SPEC_CONFIG_COUNT])() = {
+    try_flips_0, try_flips_1, try_flips_2, try_flips_3,
+    try_flips_4, try_flips_5, try_flips_6, try_flips_7,
+    try_flips_8, try_flips_9, try_flips_10, try_flips_11,
+    try_flips_12, try_flips_13, try_flips_14, try_flips_15,
+    try_flips_16, try_flips_17, try_flips_18, try_flips_19,
+    try_flips_20, try_flips_21, try_flips_22, try_flips_23,
+    try_flips_24, try_flips_25, try_flips_26, try_flips_27,
+    try_flips_28, try_flips_29, try_flips_30, try_flips_31,
+    try_flips_32, try_flips_33, try_flips_34, try_flips_35,
+    try_flips_36, try_flips_37, try_flips_38, try_flips_39,
+    try_flips_40, try_flips_41, try_flips_42, try_flips_43,
+    try_flips_44, try_flips_45, try_flips_46, try_flips_47,
+    try_flips_48, try_flips_49, try_flips_50, try_flips_51,
+    try_flips_52, try_flips_53, try_flips_54, try_flips_55,
+    try_flips_56, try_flips_57, try_flips_58, try_flips_59,
+    try_flips_60, try_flips_61, try_flips_62, try_flips_63 };
 
 int
-compute_max_diff()
-{
-    if (flag_hillclimb){
-	return length_of(down) ? 1 : 
-	  ( length_of(sideways) ? 0 : -1 );
-    }
-    else {
-	if (length_of(maxdiff)==0)
-	  init_buckets();
-	return current_max_diff;
-    }
+flip_loop_config()
+     /* Return the SPEC_CONFIG mask of the specialized flip loop that
+	handles the options given, or -1 if only the generic loop does */
+{
+    if (flag_only_unsat || flag_coloring || flag_graphics || flag_anneal || flag_paws ||
+	flag_novelty || flag_ccanr || flag_probsat || flag_plateau || flag_bigflip || flag_direction || flag_manual_pick ||
+	pause_usecs ||
+	(flag_trace & ~(FLAG_TRACE_TRIES | FLAG_TRACE_BEST | FLAG_TRACE_CLAUSES | FLAG_TRACE_ORPHANS)))
+      return -1;
+    return (flag_hillclimb ? SPEC_CONFIG_HILLCLIMB : 0) |
+      (flag_walk ? SPEC_CONFIG_WALK : 0) |
+	(tabu_list_length > 0 ? SPEC_CONFIG_TABU : 0) |
+	  (flag_weigh_clauses ? SPEC_CONFIG_WEIGH : 0) |
+	    (flag_pb ? SPEC_CONFIG_PB : 0) |
+	      (flag_record ? SPEC_CONFIG_RECORD : 0);
 }
 
-
 void
-flip_var(PROTO(int) var)
-     /* flip var and update make/critical/diff and max_diff_list */
-PARAMS( int var; )
-{  
-    int diff;
-    int old_num_bad;
-
-    old_num_bad = current_num_bad;
-    diff = assign[var].diff;
-
-    if (diff < 0)
-      ++upwards_count;
-    else if (diff == 0)
-      ++sideways_count;
-    else 
-      ++downwards_count;
-    assign[var].flip_count++;
-
-    if ((flag_trace & FLAG_TRACE_FLIPS)){
-	printf("Flip %d: var %d to %d, diff=%d, make=%d, num_bad=%d, low_bad=%d\n", 
-	       flip, var, -assign[var].value, assign[var].diff,
-	       assign[var].make,
-	       current_num_bad,
-	       low_bad);
-    }
-
-    CHECK({
-	if (is_in(tabu, (&assign[var]))){
-	    sprintf(ss, "Flipping var %d, but is tabu with diff %d\n",
-		    var, diff);
-	    crash_and_burn(ss);
-	}
-	if (flag_only_unsat && assign[var].make <= 0){
-	    sprintf(ss, "Flipping var %d, but it has make %d\n",
-		    var, assign[var].make);
-	    crash_and_burn(ss);
-	}
-    });
-
-    assign[var].value *= -1;
-
-    rotate_tabu_list(var);
-
-    update_diff(var);
-
-    if (flag_trace & FLAG_TRACE_FLIP_CLAUSES){
-	if (get_bad_clauses(1, 0) != current_num_bad){
-	    sprintf(ss, "current_num_bad=%d, but actual count is %d!\n",
-		    current_num_bad, get_bad_clauses(0,0));
-	    crash_and_burn(ss);
-	}
-    }
-
-    if (flag_trace & FLAG_TRACE_ASSIGN)
-      print_assign_stdout();
-
-    CHECK({
-	if (!flag_weigh_clauses){
-	    if (current_num_bad != (old_num_bad - diff)){
-		sprintf(ss, "Diff = %d, but current_num_bad changes from %d to %d!\n",
-			diff, old_num_bad, current_num_bad);
-		crash_and_burn(ss);
-	    }
-	}
-    });
-
-    if (current_num_bad < low_bad ){
-	low_bad = current_num_bad;
-	if (current_num_bad <= flag_save_best_max){
-	    save_current_as_low();
-	}
-    }
+select_flip_loop()
+     /* Point try_flips_selected at the flip loop for this experiment */
+{
+    flip_loop = flip_loop_config();
+    if (flip_loop < 0)
+      try_flips_selected = try_flips;
+    else
+      try_flips_selected = try_flips_table[flip_loop];
+}
 
-    if (current_num_bad < best_num_bad && current_num_bad <= flag_save_best_max){
-	save_current_as_best();
-    }
 
-    if (flag_graphics) graphics_show_variable(var, 1);
-#ifndef NO_USLEEP
-    if (pause_usecs)
-      usleep(pause_usecs);
-#endif
-}
 /**************************************/
 /*  Big Flips                         */
 /**************************************/
@@ -2859,6 +3071,7 @@ big_flip()
     int var;
     int flipsize;
     int pr;
+    int diff, make;
 
     pr = !!(flag_trace & FLAG_TRACE_FLIPS);
 
@@ -2873,8 +3086,14 @@ big_flip()
 	if (random_01_odds( INT_PROB_BASE/2 )){
 	    if (pr) printf("*");
 	    assign[var].flip_count++;
+	    diff = assign[var].diff;
+	    make = assign[var].make;
 	    assign[var].value *= -1;
 	    update_diff(var);
+	    if (flag_record){
+		record_source = RECORD_BIGFLIP;
+		record_flip(var, diff, make);
+	    }
 	}
     }
     if (pr) printf("\n");
@@ -2931,6 +3150,10 @@ check_assign_best()
 	    clause_index += clause_len + 1;
 	}
     }
+    if (flag_pb && pb_count_bad(0, 1) > 0){
+	printf("\nWFF *NOT* SATISFIED BY ASSIGN\n");
+	return 0;
+    }
     printf("\nWFF SATISFIED BY ASSIGN\n"); 
     return 1;
 }
@@ -2992,6 +3215,7 @@ PARAMS(int print_flag; int update_flag;)
 	    clause_index += clause_len + 1;
 	}
     }
+    if (flag_pb) num_bad += pb_count_bad(print_flag, 0);
     if (print_flag) printf("Total bad clauses = %d\n", num_bad);
     return num_bad;
 }
@@ -3006,13 +3230,24 @@ void
 main_init_experiment(PROTO(char **) argv, PROTO(int) argc)
 PARAMS( char ** argv; int argc; )
 {
-  setbuf(stdout,NULL);
+  static char stdout_buffer[STDOUT_BUFFER_SIZE];
+
+  /* Unbuffered only for someone at the terminal.  Otherwise every
+     trace line would be a write of its own; stdout is flushed at the
+     end of each try, and before forks and prompts. */
+  if (interactive())
+    setbuf(stdout,NULL);
+  else
+    setvbuf(stdout, stdout_buffer, _IOFBF, (size_t) STDOUT_BUFFER_SIZE);
 
   if ((try_stat_filep = tmpfile()) ==  NULL)
     crash_and_burn("Cannot create scratch file");
 
   parse_parameters();
+  if (flag_phases) phase_begin(PHASE_INIT_EXPERIMENT);
+  if (flag_phases) phase_begin(PHASE_READ_IN);
   read_in();
+  if (flag_phases) phase_end(PHASE_READ_IN);
   printf("Wff read\n");
   if (max_flips<0){
       max_flips = (-max_flips)*nvars;
@@ -3025,11 +3260,20 @@ PARAMS( char ** argv; int argc; )
       exit(0);
   }
 
+  if (flag_reorder)
+	 reorder_wff();
+
+  if (flag_pb)
+	 pb_read();
+
   if (flag_graphics)
 	 graphics_init(argv, argc);
 
   init_rand();    
+  if (flag_phases) phase_begin(PHASE_INIT_POINTERS);
   init_pointers();
+  if (flag_phases) phase_end(PHASE_INIT_POINTERS);
+  select_flip_loop();
   if (flag_trace & FLAG_TRACE_CLAUSES){
       print_wff();
       print_wff_clauses();
@@ -3042,6 +3286,7 @@ PARAMS( char ** argv; int argc; )
   if(signal(SIGQUIT, SIG_IGN) != SIG_IGN)
     signal(SIGQUIT, handle_interrupt);
   signal(SIGTERM, handle_interrupt);
+  progress_install();
 
   experiment_seconds = 0;
   elapsed_seconds();
@@ -3058,6 +3303,14 @@ PARAMS( char ** argv; int argc; )
   total_sum_tries = 0;
   total_after_init_num_bad = 0;
   boost_on = 0;
+
+  if (flag_stream) stream_start();
+  if (flag_record) record_start();
+  if (flag_progress) progress_start();
+  if (flag_worker) cluster_worker_start();
+  if (flag_elite) elite_start();
+  if (flag_checkpoint || flag_resume) checkpoint_start();
+  if (flag_phases) phase_end(PHASE_INIT_EXPERIMENT);
 }
 
 
@@ -3065,6 +3318,7 @@ void
 main_init_try()
 {
 
+    if (flag_phases) phase_begin(PHASE_INIT_TRY);
     if (flag_graphics) graphics_start_try();
 
     total_sum_tries++;
@@ -3077,12 +3331,22 @@ main_init_try()
 	if (flag_trace) printf("Resetting weights\n");
     }
 
+    if (flag_phases) phase_begin(PHASE_INIT_ASSIGN);
     init_assign_values();
+    if (flag_phases) phase_end(PHASE_INIT_ASSIGN);
+    if (flag_phases) phase_begin(PHASE_INIT_DIFF);
     init_diff();
+    if (flag_phases) phase_end(PHASE_INIT_DIFF);
     init_tabu();
+    if (flag_phases) phase_begin(PHASE_INIT_BUCKETS);
     init_buckets();
+    if (flag_phases) phase_end(PHASE_INIT_BUCKETS);
 
     if (flag_anneal) anneal_initialize();
+    if (flag_paws) paws_initialize();
+    if (flag_novelty) novelty_initialize();
+    if (flag_ccanr) ccanr_initialize();
+    if (flag_probsat) probsat_initialize();
 
     /* initialize the directional counts */
     downwards_count = 0;
@@ -3102,12 +3366,22 @@ main_init_try()
     if (flag_trace & FLAG_TRACE_ASSIGN)
       print_assign_stdout();
 
+    if (flag_record) record_start_try();
+    if (flag_tempering) tempering_start_try();
+
     if (flag_graphics) graphics_end_try_initialization();
+    if (flag_phases) phase_end(PHASE_INIT_TRY);
 }
 
 void
 main_gather_try_stats()
 {
+      int low_saved_bad;	/* bad clauses of the assignment in value_low */
+
+      if (flag_phases) phase_begin(PHASE_TRY_STATS);
+      if (flag_tempering) tempering_end_try();
+      if (flag_elite) elite_end_try();
+
       total_downwards += downwards_count;
       total_upwards += upwards_count;
       total_sideways += sideways_count;
@@ -3116,10 +3390,19 @@ main_gather_try_stats()
       total_null += null_count;
 
       update_positive_count();
+      if (flag_novelty) novelty_end_try();
 
       if (get_bad_clauses(flag_trace & FLAG_TRACE_CLAUSES, (reset_weight_tries != 0)) != current_num_bad) {
 	  crash_and_burn("ERROR: current_num_bad is wrong!\n");
       }
+      CHECK({
+	  if (!flag_coloring && flip_loop < 0 &&
+	      num_false_clauses + (flag_pb ? pb_num_false : 0) != current_num_bad) {
+	      sprintf(ss, "ERROR: %d clauses in false clause list, but current_num_bad=%d\n",
+		      num_false_clauses + (flag_pb ? pb_num_false : 0), current_num_bad);
+	      crash_and_burn(ss);
+	  }
+      });
 
       /* Note: do NOT save best if no better than previous best, soas not to make the best_flip etc
 	 values appear unnecessarily large! */
@@ -3133,11 +3416,16 @@ main_gather_try_stats()
       }
       /* Note that test is <=, so low is updated at end of try even if no better than former low */
       /* This is important for adaptive starts. */
+      low_saved_bad = low_bad;
       if (current_num_bad <= low_bad || low_bad > flag_save_best_max){
 	  save_current_as_low();
 	  if (current_num_bad < low_bad) low_bad = current_num_bad;
+	  low_saved_bad = current_num_bad;
       }
 
+      if (flag_population) population_end_try(low_saved_bad);
+      if (flag_elite) elite_publish(low_saved_bad);
+
       update_bad_clause_count(low_bad);
       if (low_bad == 0 || (try_this_assign % reset_tries == 0)){
 	  update_reset_bad_clause_count(low_bad);
@@ -3150,13 +3438,18 @@ main_gather_try_stats()
 	    ((try_this_assign - 1) % reset_tries) * max_flips;
 	  total_successful_reset_count += ((try_this_assign-1)% reset_tries )+1 ;
       }
+      if (flag_record) record_end_try();
+      if (flag_stream) stream_try();
       if (current_try % report_interval == 0){
 	  experiment_seconds += elapsed_seconds();
 	  print_report("INTERMEDIATE REPORT");
+	  if (flag_stream) stream_report("INTERMEDIATE REPORT");
 	  elapsed_seconds();
       }
 
       if (flag_trace) print_try_statistics();
+      fflush(stdout);
+      if (flag_phases) phase_end(PHASE_TRY_STATS);
 }
 
 
@@ -3165,11 +3458,20 @@ main_wrapup(PROTO(char *) msg)
 PARAMS(char * msg; )
 {
 
+  if (flag_phases) phase_begin(PHASE_WRAPUP);
+  if (flag_elite) elite_stop();
+  if (flag_progress) progress_finish();
+  if (flag_worker) cluster_worker_finish();
   experiment_seconds += elapsed_seconds();
+  if (flag_checkpoint) checkpoint_finish();
+  if (flag_phases) phase_end(PHASE_WRAPUP);
 
   print_report(msg);
+  if (flag_stream) stream_finish(msg);
+  if (flag_record) record_finish();
   if (flag_trace) print_best_statistics();
   print_assignment_file();
+  if (flag_format == FLAG_FORMAT_NL) ampl_write_sol();
 
   if (best_num_bad == 0 && check_assign_best()==0) {
       crash_and_burn("ERROR!  Thought best_num_bad was 0, but assignment no good!\n");
@@ -3208,49 +3510,43 @@ PARAMS(int i; )
 /*  MAIN       */
 /***************/
 
-int
-main(PROTO(int) argc, PROTO(char **) argv)
-PARAMS( char ** argv; int argc; )
+void
+main_tries()
+     /* Make tries until the wff is satisfied (unless m) or max_tries */
 {
-  int var;
   int base_max_flips;
 
-  main_init_experiment(argv, argc);
   base_max_flips = max_flips;
-
   current_try = 0; try_this_assign = 0; 
-  while (current_try < max_tries) {
-      current_try++;  try_this_assign++;
+  if (flag_resume){
+      checkpoint_resume();
+      /* the run resumed was already over */
+      if (!checkpoint_in_try && current_try > 0 && current_num_bad == 0 &&
+	  flag_multiple_assigns != 1) return;
+  }
+  while (current_try < max_tries || checkpoint_in_try) {
+      if (checkpoint_in_try){
+	  /* resumed between two flips of try current_try */
+	  if (flag_record) record_start_try();
+      }
+      else {
+	  if (flag_checkpoint) checkpoint_try();
+	  current_try++;  try_this_assign++;
 
-      flip = 0;
-      main_init_try();
+	  flip = 0;
+	  main_init_try();
+      }
 
       if (flag_superlinear) max_flips = base_max_flips * super(try_this_assign);
 
-      while (flip < max_flips || (boost_on && flip < max_flips + boost_amount)){
+      if (flag_phases) phase_begin(PHASE_SEARCH);
+      checkpoint_in_try = 1;
+      (*try_flips_selected)();
+      checkpoint_in_try = 0;
+      if (flag_phases) phase_end(PHASE_SEARCH);
 
-	  if (flag_graphics) graphics_start_flip();
-
-	  if (current_num_bad == 0) break;
-	  current_max_diff = compute_max_diff();
-	  if (flag_direction == 1 && current_max_diff <= 0) break;
-	  if (flag_direction == 2 && current_max_diff < 0) break; 
-	  if (flag_bigflip){
-	      flip++;
-	      big_flip();
-	  }
-	  else {
-	      var = pick_rand_var();
-	      if (var == 0) break;
-	      flip++;
-	      flip_var(var);
-	  }
-	  if (flip == max_flips && current_num_bad <= boost_threshhold){
-	      boost_on = 1;
-	      if (flag_trace) printf("BOOSTING\n");
-	  }
-      }
       main_gather_try_stats();
+      if (signals_pending) service_signals();
       if (current_num_bad == 0){
 	  try_this_assign = 0;
 	  if (flag_multiple_assigns != 1) {
@@ -3258,6 +3554,24 @@ PARAMS( char ** argv; int argc; )
 	  }
       }
   }
+}
+
+int
+main(PROTO(int) argc, PROTO(char **) argv)
+PARAMS( char ** argv; int argc; )
+{
+  main_init_experiment(argv, argc);
+
+  if (flag_coordinate){
+      cluster_coordinate();
+      main_wrapup(NULL);
+      return(0);
+  }
+
+  if (flag_rtd)
+    rtd_run();
+  else
+    main_tries();
   main_wrapup(NULL);
   return(0);
 }
@@ -80,6 +80,7 @@ extern int scratch;		/* integer absolute value */
 #define DEFAULT_ONE_BIT_MASK (0100000)	/* Bit used for random flips */
 #define INT_PROB_BASE 10000000 
 #define SAVE_BEST_MAX_DEFAULT 20
+#define STDOUT_BUFFER_SIZE (1 << 20) /* stdout buffer when not interactive */
 /* Used as the implicit base for parameters which are probabilities stored as integers.  */
 
 #define PROGRAM_NAME "program: gsat version 41, July 1995\n"
@@ -124,14 +125,15 @@ typedef struct var_str {
     int positive_count;		/* number of times variable is 1 at end of try */
     int flip_count;		/* number of times variable is flipped */
     int first;			/* index into wff of first clause containing var */
+    int score;			/* diff of the score bucket holding var, see score.h */
+    int score_pos;		/* position in that bucket, 0 = not in a bucket */
+    int last_flip;		/* flip at which var was last flipped in this try */
     /* Following hold lists, are NOT indexed by var! */
     int lastwalk;
     indexed_list walk;		/* list of vars with make values > 0 */
     indexed_list up;		/* list of vars with diff values < 0 */
     indexed_list down;		/* list of vars with diff values > 0 */
     indexed_list sideways;	/* list of vars with diff values = 0 */
-    indexed_list maxdiff;	/* list of var with max diff */
-    indexed_list tabu;		/* tabu list */
     indexed_list free;		/* list of unassigned vars */
 } *var_str_ptr;        
 
@@ -139,11 +141,6 @@ extern
 var_str_ptr assign;		/* assign is global array containing the assignment */
 				/* variable n stored at assign[n] */
 				/* size = nvars + 1 */
-extern
-int
-  tabu_in,			/* indexes of first/last element in tabu list */
-  tabu_out;
-
 typedef struct bad_clause_count_str {
   int value;			/* number of times there were this many bad clauses */
 } *bad_clause_count_str_ptr;        
@@ -163,6 +160,17 @@ int * clause_index_to_num;	/* array mapping clause indexes to clause numbers,
 extern
 int * clause_num_to_index;	/* array mapping clause numbers to clause indexes,
 				   where indexes correspond to wff[] indexes */
+
+extern
+int * false_clause;		/* false_clause[1..num_false_clauses] are the wff[] */
+				/* indexes of the unsatisfied clauses (not */
+				/* maintained with the color option, or by */
+				/* the specialized flip loops) */
+extern
+int * false_clause_pos;		/* indexed by wff[] index: position in false_clause, */
+				/* 0 = clause is satisfied */
+extern
+int num_false_clauses;
 
 /****************************/
 /*  Current State           */
@@ -303,6 +311,30 @@ extern
 int
   flag_superlinear;
 
+#define FLAG_PAGES_HUGE 1	/* MAP_HUGETLB, else transparent huge pages */
+#define FLAG_PAGES_THP 2	/* transparent huge pages only */
+
+extern
+int
+  flag_pages;			/* != 0 back wff and assign with huge pages */
+
+extern
+long
+  page_size_obtained;		/* page size actually backing wff and assign */
+
+extern
+int
+  flag_reorder;			/* != 0 renumber vars and clauses for locality, see reorder.h */
+
+extern
+int
+  flip_loop;			/* SPEC_CONFIG of the specialized flip loop in use, */
+				/* -1 = generic, see flip_template.h */
+
+extern
+volatile sig_atomic_t
+  signals_pending;		/* 1 = a signal handler left work for service_signals */
+
 #define FLAG_TRACE_FLIPS 1
 #define FLAG_TRACE_FLIP_CLAUSES 2
 #define FLAG_TRACE_DIFFS 4
@@ -323,6 +355,7 @@ int
 #define FLAG_FORMAT_KF 2
 #define FLAG_FORMAT_CNF 3
 #define FLAG_FORMAT_LISP 4
+#define FLAG_FORMAT_NL 5
 
 extern
 char *flag_trace_names[];
@@ -349,7 +382,24 @@ int
   flag_weigh_clauses,		/* 1 = use the clause weights in calculating the diffs */
   flag_coloring,		/* != 0 assume "implicit" k-coloring clauses */
   flag_trace,			/* Each bit specifies feature to trace */
-  flag_anneal;			/* 1 = perform simulated annealing */
+  flag_anneal,			/* 1 = perform simulated annealing */
+  flag_paws,			/* 1 = increase weights of false clauses at local minima */
+  flag_novelty,			/* 1 = pick by Novelty from a random false clause */
+  flag_ccanr,			/* 1 = pick by configuration checking (CCAnr) */
+  flag_probsat,			/* 1 = pick by probSAT from a random false clause */
+  flag_tempering,		/* 1 = anneal replicas at a ladder of temperatures */
+  flag_population,		/* 1 = start tries by crossover of a pool of elites */
+  flag_elite,			/* 1 = share the best assignment among worker processes */
+  flag_coordinate,		/* 1 = coordinate gsat workers over sockets */
+  flag_worker,			/* 1 = work for a coordinator over a socket */
+  flag_pb,			/* 1 = also search over pseudo-Boolean rows */
+  flag_stream,			/* 1 = append stats records to a stream file */
+  flag_record,			/* 1 = record every flip to a binary file */
+  flag_phases,			/* 1 = time phases of the run, for the report */
+  flag_progress,		/* 1 = keep live progress in shared memory */
+  flag_rtd,			/* 1 = make independent runs for a run-length distribution */
+  flag_checkpoint,		/* 1 = write checkpoints to a file */
+  flag_resume;			/* 1 = go on from a checkpoint */
 
 extern
 int
@@ -430,6 +480,23 @@ char ss[10000];			/* scratch string */
     } \
     printf("\n"); }
 
+#define add_false_clause(INDEX) \
+{ false_clause[false_clause_pos[INDEX] = ++num_false_clauses] = (INDEX); }
+
+#define delete_false_clause(INDEX) \
+{ false_clause_pos[false_clause[false_clause_pos[INDEX]] = false_clause[num_false_clauses--]] = \
+    false_clause_pos[INDEX]; \
+  false_clause_pos[INDEX] = 0; }
+
+/* last_flip is set by flip_var on every flip.  A var is tabu while
+   fewer than tabu_list_length flips have been made since it was
+   flipped.  Tabu vars stay in the buckets and the walk
+   list, and are skipped when picking. */
+#define is_tabu(VARPTR) \
+  (flip - (VARPTR)->last_flip < tabu_list_length)
+
+#define TABU_PICK_TRIES 8	/* random probes for a non-tabu member before scanning */
+
 #define random_member(KEY) \
   (assign[random_1_to(length_of(KEY))].KEY.list)
 
@@ -450,6 +517,21 @@ EXTERN_FUNCTION( void print_report, (char * message));
 EXTERN_FUNCTION( int pick_greedy_var, ());
 EXTERN_FUNCTION( int lit_of_clause_num, (int lit_num, int clause_num));
 EXTERN_FUNCTION( int length_of_clause_num, (int clause_num));
+EXTERN_FUNCTION( int allowed_member_up, (int pick));
+EXTERN_FUNCTION( int allowed_member_down, (int pick));
+EXTERN_FUNCTION( int allowed_member_sideways, (int pick));
+EXTERN_FUNCTION( int allowed_member_walk, (int pick));
+EXTERN_FUNCTION( void clear_out_lists, ());
+EXTERN_FUNCTION( void init_diff, ());
+EXTERN_FUNCTION( void init_tabu, ());
+EXTERN_FUNCTION( void init_buckets, ());
+EXTERN_FUNCTION( void save_current_as_low, ());
+EXTERN_FUNCTION( void save_current_as_best, ());
+EXTERN_FUNCTION( void graphics_show_variable, (int var, int flipping));
+EXTERN_FUNCTION( void allocate_memory, ());
+EXTERN_FUNCTION( double elapsed_seconds, ());
+EXTERN_FUNCTION( void main_tries, ());
+EXTERN_FUNCTION( void service_signals, ());
 
 #endif
 
@@ -0,0 +1,191 @@
+/* novelty.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Novelty and Novelty+ picks (McAllester, Selman & Kautz, "Evidence
+   for invariants in local search"; Hoos, "On the run-time behaviour of
+   stochastic local search algorithms for SAT"), with the adaptive
+   noise mechanism of Hoos, "An adaptive noise mechanism for WalkSAT".
+
+   Each flip chooses a random false clause and looks only at its vars.
+   The var with the best diff is flipped, ties going to the var flipped
+   longest ago, unless it is the most recently flipped var of the
+   clause; then the second best is flipped instead with probability
+   equal to the noise.  Novelty+ first flips a random var of the clause
+   with probability novelty_wp.
+
+   With adaptive noise the noise starts at 0.  If num_bad has not
+   improved for nclauses / NOVELTY_THETA flips it is raised by a
+   fraction NOVELTY_PHI of the way to 1; each improvement lowers it by
+   a fraction NOVELTY_PHI / 2. */
+
+#include "gsat.h"
+#include "novelty.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define NOVELTY_NOISE_DEFAULT 0.5
+#define NOVELTY_THETA 6		/* stagnation = nclauses / 6 flips without improvement */
+#define NOVELTY_PHI 5		/* raise noise by 1/5 of the way to 1, lower by 1/10 */
+
+int novelty_noise;		/* odds of taking the second best var */
+int novelty_wp;			/* odds of a random var of the clause (Novelty+) */
+int novelty_adaptive;		/* 1 = adapt novelty_noise during the try */
+int novelty_adapt_flip;		/* flip of the last adaptation */
+int novelty_adapt_bad;		/* num_bad at the last adaptation */
+int novelty_noise_start;	/* noise given by the option */
+double novelty_noise_sum;	/* noise at the end of each try, summed */
+int novelty_tries;
+
+
+int
+novelty_parse_parameters(PROTO(char *) inputline)
+     /* Parse "novelty [P|adaptive [WP]]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    char word[100];
+    float p, wp;
+
+    p = NOVELTY_NOISE_DEFAULT;
+    wp = 0.0;
+    novelty_adaptive = 0;
+    word[0] = 0;
+    if (sscanf(inputline, " novelty %s %f", word, &wp) >= 1){
+	if (strcmp(word, "adaptive") == 0){
+	    novelty_adaptive = 1;
+	    p = 0.0;
+	}
+	else if (sscanf(word, "%f", &p) != 1){
+	    sprintf(ss, " Error: bad novelty noise %s\n", word);
+	    crash_maybe(ss);
+	    p = NOVELTY_NOISE_DEFAULT;
+	}
+    }
+    if (p < 0.0 || p > 1.0 || wp < 0.0 || wp > 1.0){
+	crash_maybe(" Error: novelty probabilities must be between 0 and 1\n");
+	p = NOVELTY_NOISE_DEFAULT;
+	wp = 0.0;
+    }
+    novelty_noise_start = (p * INT_PROB_BASE);
+    novelty_wp = (wp * INT_PROB_BASE);
+    novelty_noise_sum = 0.0;
+    novelty_tries = 0;
+    if (novelty_adaptive)
+      printf(" option: novelty%s, adaptive noise\n", novelty_wp ? "+" : "");
+    else
+      printf(" option: novelty%s, noise %f\n", novelty_wp ? "+" : "", p);
+    if (novelty_wp)
+      printf("         random walk in clause %f\n", wp);
+    return 1;
+}
+
+void
+novelty_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_novelty: %d\n", flag_novelty);
+    fprintf(fp_report, "novelty_noise: %f\n", ((double)novelty_noise_start)/INT_PROB_BASE);
+    fprintf(fp_report, "novelty_wp: %f\n", ((double)novelty_wp)/INT_PROB_BASE);
+    fprintf(fp_report, "novelty_adaptive: %d\n", novelty_adaptive);
+    if (novelty_adaptive && novelty_tries)
+      fprintf(fp_report, "novelty_mean_final_noise: %f\n", novelty_noise_sum / novelty_tries);
+}
+
+void
+novelty_initialize()
+     /* Called at the start of each try, after init_diff has built the
+	false clause list */
+{
+    if (flag_coloring)
+      crash_and_burn("ERROR: novelty cannot be used with the color option\n");
+    novelty_noise = novelty_noise_start;
+    novelty_adapt_flip = 0;
+    novelty_adapt_bad = current_num_bad;
+}
+
+void
+novelty_end_try()
+     /* Called at the end of each try */
+{
+    novelty_noise_sum += ((double)novelty_noise)/INT_PROB_BASE;
+    novelty_tries++;
+}
+
+static void
+novelty_adapt()
+     /* Adjust the noise for the progress made since the last adjustment */
+{
+    if (current_num_bad < novelty_adapt_bad){
+	novelty_noise -= novelty_noise / (2 * NOVELTY_PHI);
+	novelty_adapt_flip = flip;
+	novelty_adapt_bad = current_num_bad;
+    }
+    else if (flip - novelty_adapt_flip > nclauses / NOVELTY_THETA){
+	novelty_noise += (INT_PROB_BASE - novelty_noise) / NOVELTY_PHI;
+	novelty_adapt_flip = flip;
+	novelty_adapt_bad = current_num_bad;
+    }
+}
+
+int
+novelty_pick_var()
+     /* Pick a var of a random false clause; 0 if there are none */
+{
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp, best, second, youngest;
+    int j, clause_len;
+
+    if (num_false_clauses == 0) return 0;
+    if (novelty_adaptive) novelty_adapt();
+
+    clause_ptr = &wff[false_clause[random_1_to(num_false_clauses)]];
+    clause_len = clause_ptr->lit;
+
+    if (novelty_wp && random_01_odds(novelty_wp))
+      return abs_val(clause_ptr[random_1_to(clause_len)].lit);
+
+    best = second = youngest = NULL;
+    for (j = 1; j <= clause_len; j++){
+	vp = &assign[abs_val(clause_ptr[j].lit)];
+	if (vp->last_flip > 0 &&
+	    (youngest == NULL || vp->last_flip > youngest->last_flip))
+	  youngest = vp;
+	if (best == NULL || vp->diff > best->diff ||
+	    (vp->diff == best->diff && vp->last_flip < best->last_flip)){
+	    second = best;
+	    best = vp;
+	}
+	else if (second == NULL || vp->diff > second->diff ||
+		 (vp->diff == second->diff && vp->last_flip < second->last_flip))
+	  second = vp;
+    }
+
+    if (best == youngest && second != NULL && random_01_odds(novelty_noise))
+      return second->name;
+    return best->name;
+}
+
+void
+novelty_checkpoint()
+{
+    checkpoint_data((char *) &novelty_noise_sum, (long) sizeof(double));
+    checkpoint_data((char *) &novelty_tries, (long) sizeof(int));
+}
+
+void
+novelty_checkpoint_try()
+     /* The noise as adapted so far in the try */
+{
+    checkpoint_data((char *) &novelty_noise, (long) sizeof(int));
+    checkpoint_data((char *) &novelty_adapt_flip, (long) sizeof(int));
+    checkpoint_data((char *) &novelty_adapt_bad, (long) sizeof(int));
+}
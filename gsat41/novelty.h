@@ -0,0 +1,26 @@
+/* novelty.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef NOVELTY_H
+#define NOVELTY_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int novelty_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void novelty_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void novelty_initialize, ());
+EXTERN_FUNCTION( void novelty_end_try, ());
+EXTERN_FUNCTION( int novelty_pick_var, ());
+EXTERN_FUNCTION( void novelty_checkpoint, ());
+EXTERN_FUNCTION( void novelty_checkpoint_try, ());
+
+#endif
@@ -0,0 +1,227 @@
+/* paws.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Dynamic clause weighting during a try, after PAWS (Thornton et al.,
+   "Additive versus multiplicative clause weighting for SAT").  When
+   the search reaches a local minimum -- no variable with diff > 0 --
+   the weight of every false clause is increased by 1, unless the
+   minimum is flat and a sideways move is taken instead.  After every
+   paws_period increases, every clause with weight > 1 is decreased
+   by 1.  Smoothing only visits the clauses on the heavy list, and
+   each change of weight updates the diffs and makes of the vars in
+   that clause directly, so no pass over the whole wff is needed.
+   The weights live in wff[].next as for the weight option, and
+   the weight option's end-of-try increments still apply. */
+
+#include "gsat.h"
+#include "score.h"
+#include "adjust_bucket.h"
+#include "paws.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define PAWS_PERIOD_DEFAULT 10
+#define PAWS_FLAT_DEFAULT 0.15
+
+int paws_period;		/* number of weight increases between smoothings */
+int paws_flat_odds;		/* odds of a sideways move at a flat minimum */
+int paws_increases;		/* weight increases so far (local minima) */
+int paws_smooths;		/* smoothings so far */
+int paws_max_weight;		/* greatest weight reached */
+
+int *heavy_clause = NULL;	/* heavy_clause[1..num_heavy] are the wff[] indexes */
+				/* of clauses with weight > 1 */
+int *heavy_pos = NULL;		/* indexed by wff[] index: position in heavy_clause */
+int num_heavy;
+
+
+int
+paws_parse_parameters(PROTO(char *) inputline)
+     /* Parse "paws [N [F]]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    float f;
+
+    paws_period = PAWS_PERIOD_DEFAULT;
+    f = PAWS_FLAT_DEFAULT;
+    if (sscanf(inputline, " paws %d %f", &paws_period, &f) < 1)
+      paws_period = PAWS_PERIOD_DEFAULT;
+    if (paws_period < 1){
+	crash_maybe(" Error: paws smoothing period must be at least 1\n");
+	paws_period = PAWS_PERIOD_DEFAULT;
+    }
+    paws_flat_odds = (f * INT_PROB_BASE);
+    printf(" option: paws, smooth after %d increases, flat moves %f\n", paws_period, f);
+    return 1;
+}
+
+void
+paws_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_paws: %d\n", flag_paws);
+    fprintf(fp_report, "paws_period: %d\n", paws_period);
+    fprintf(fp_report, "paws_flat: %f\n", ((double)paws_flat_odds)/INT_PROB_BASE);
+    fprintf(fp_report, "paws_increases: %d\n", paws_increases);
+    fprintf(fp_report, "paws_smooths: %d\n", paws_smooths);
+    fprintf(fp_report, "paws_max_weight: %d\n", paws_max_weight);
+}
+
+static void
+paws_allocate()
+     /* Make the list of heavy clauses, on first use */
+{
+    int i;
+
+    heavy_clause = (int *) malloc((size_t)((nclauses + 1) * sizeof(int)));
+    heavy_pos = (int *) malloc((size_t)((nlits + nclauses + 1) * sizeof(int)));
+    for (i = 0; i <= nlits + nclauses; i++) heavy_pos[i] = 0;
+    num_heavy = 0;
+    paws_increases = 0;
+    paws_smooths = 0;
+    paws_max_weight = 1;
+}
+
+void
+paws_initialize()
+     /* Called at the start of each try, after the weights are set and
+	init_diff has built the false clause list */
+{
+    int i, clause_index;
+
+    if (flag_coloring)
+      crash_and_burn("ERROR: paws cannot be used with the color option\n");
+
+    if (heavy_clause == NULL) paws_allocate();
+    for (i = 1; i <= num_heavy; i++) heavy_pos[heavy_clause[i]] = 0;
+    num_heavy = 0;
+
+    /* Weights may carry over from the previous try */
+    clause_index = 1;
+    for (i = 1; i <= nclauses; i++){
+	if (wff[clause_index].next > 1){
+	    heavy_clause[heavy_pos[clause_index] = ++num_heavy] = clause_index;
+	    if (wff[clause_index].next > paws_max_weight)
+	      paws_max_weight = wff[clause_index].next;
+	}
+	clause_index += wff[clause_index].lit + 1;
+    }
+}
+
+static void
+paws_increase(PROTO(int) clause_index)
+     /* Add 1 to the weight of a false clause: flipping any of its vars
+	now gains 1 more */
+PARAMS( int clause_index; )
+{
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp;
+    int j, clause_len;
+
+    clause_ptr = &wff[clause_index];
+    clause_len = clause_ptr->lit;
+    if (++(clause_ptr->next) == 2)
+      heavy_clause[heavy_pos[clause_index] = ++num_heavy] = clause_index;
+    if (clause_ptr->next > paws_max_weight)
+      paws_max_weight = clause_ptr->next;
+    for (j = 1; j <= clause_len; j++){
+	vp = &assign[abs_val((++clause_ptr)->lit)];
+	vp->diff++;
+	vp->make++;
+	adjust_bucket(vp);
+    }
+}
+
+static void
+paws_decrease(PROTO(int) clause_index)
+     /* Subtract 1 from the weight of a clause with weight > 1 */
+PARAMS( int clause_index; )
+{
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp, crit;
+    int j, clause_len, npos;
+
+    clause_ptr = &wff[clause_index];
+    clause_len = clause_ptr->lit;
+    clause_ptr->next--;
+
+    npos = 0;
+    crit = NULL;
+    for (j = 1; j <= clause_len; j++){
+	if (same_sign(assign[abs_val(clause_ptr[j].lit)].value, clause_ptr[j].lit)){
+	    npos++;
+	    crit = &assign[abs_val(clause_ptr[j].lit)];
+	}
+    }
+    if (npos == 0){
+	/* false: each var makes 1 less */
+	for (j = 1; j <= clause_len; j++){
+	    vp = &assign[abs_val(clause_ptr[j].lit)];
+	    vp->diff--;
+	    vp->make--;
+	    adjust_bucket(vp);
+	}
+    }
+    else if (npos == 1){
+	/* the critical var breaks 1 less */
+	crit->diff++;
+	adjust_bucket(crit);
+    }
+}
+
+int
+paws_local_minimum()
+     /* Called when no var has diff > 0.  Returns 0 if a sideways move
+	should be taken, else increases the weights of the false clauses
+	(smoothing every paws_period times) and returns 1. */
+{
+    int i, clause_index;
+
+    if (current_max_diff == 0 && random_01_odds(paws_flat_odds))
+      return 0;
+
+    for (i = 1; i <= num_false_clauses; i++)
+      paws_increase(false_clause[i]);
+
+    if (++paws_increases % paws_period == 0){
+	paws_smooths++;
+	/* Walk the heavy list backwards, so that clauses swapped in
+	   from the end have already been visited */
+	for (i = num_heavy; i >= 1; i--){
+	    clause_index = heavy_clause[i];
+	    paws_decrease(clause_index);
+	    if (wff[clause_index].next == 1){
+		heavy_pos[heavy_clause[i] = heavy_clause[num_heavy--]] = i;
+		heavy_pos[clause_index] = 0;
+	    }
+	}
+    }
+    return 1;
+}
+
+void
+paws_checkpoint()
+     /* The weights are in the wff; the count of raises sets the smoothing */
+{
+    if (heavy_clause == NULL) paws_allocate();
+    checkpoint_data((char *) &paws_increases, (long) sizeof(int));
+    checkpoint_data((char *) &paws_smooths, (long) sizeof(int));
+    checkpoint_data((char *) &paws_max_weight, (long) sizeof(int));
+}
+
+void
+paws_checkpoint_try()
+     /* The heavy clauses, in the order smoothing visits them */
+{
+    checkpoint_list(heavy_clause, heavy_pos, &num_heavy);
+}
@@ -0,0 +1,25 @@
+/* paws.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef PAWS_H
+#define PAWS_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int paws_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void paws_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void paws_initialize, ());
+EXTERN_FUNCTION( int paws_local_minimum, ());
+EXTERN_FUNCTION( void paws_checkpoint, ());
+EXTERN_FUNCTION( void paws_checkpoint_try, ());
+
+#endif
@@ -0,0 +1,470 @@
+/* pb.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Pseudo-Boolean rows.  Besides the clauses of the wff, gsat can
+   search over linear 0-1 rows read from a file in the format that
+   ampl2eqn writes and eqn2clause reads:
+
+       n  x_1 c_1  ...  x_n c_n  reln c0 [c0upper]
+
+   where reln is 0 (between c0 and c0upper), 1 (<=), 2 (>=), 3 (<),
+   4 (=) or 5 (>), or the same relation spelled out.  Each row is kept
+   as one or two rows sum c_i l_i >= need, with positive coefficients
+   on literals, instead of the clauses that eqn2clause would expand it
+   into.  The rows of an AMPL .nl wff file come here the same way.
+
+   A false row counts as one bad clause.  Each row keeps the sum of
+   the coefficients of its true lits, so a flip updates it in constant
+   time.  A var of a false row makes it if flipping it would lift the
+   sum to need, and a var of a true row breaks it if flipping it would
+   drop the sum below need; these go into the var's diff and make just
+   as for clauses.  They can only be nonzero while the sum is within
+   the row's largest coefficient of need, so the members' diffs are
+   only revisited when a flip moves the sum within that window.
+
+   Rows count 1 whatever the clause weights, and do not appear in the
+   list of false clauses, so the options that pick from false clauses
+   or weigh them are not allowed with pb rows. */
+
+#include "gsat.h"
+#include "score.h"
+#include "adjust_bucket.h"
+#include "reorder.h"
+#include "pb.h"
+#include "ampl.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define PB_LOWER_UPPER 0
+#define PB_LESS_EQUAL 1
+#define PB_GREATER_EQUAL 2
+#define PB_LESS 3
+#define PB_EQUAL 4
+#define PB_GREATER 5
+
+typedef struct pb_row_str {
+    int need;			/* row holds when sum >= need */
+    int sum;			/* coefficients of the true lits */
+    int max_coeff;		/* window of sums where members make or break */
+    int start;			/* terms start..start+len-1 */
+    int len;
+    int input_row;		/* number of the row in the file */
+} *pb_row_ptr;
+
+char pb_file[MAXLINE];
+int pb_offset;			/* 1 = vars are numbered from 0 in the file */
+int pb_num_rows;		/* rows >= kept */
+int pb_num_input_rows;		/* rows in the file */
+int pb_num_terms;
+int pb_num_false;		/* rows that are false now */
+int pb_window_visits;		/* flips that revisited a row's members */
+struct pb_row_str *pb_row = NULL;
+int *pb_lit = NULL;		/* lit of each term */
+int *pb_coeff = NULL;		/* coefficient of each term, > 0 */
+int *pb_term_row = NULL;	/* row of each term */
+int *pb_occ_start = NULL;	/* terms of var v are pb_occ[pb_occ_start[v]..pb_occ_start[v+1]-1] */
+int *pb_occ = NULL;
+
+int pb_max_rows, pb_max_terms;
+
+/* 1 if flipping a member with coefficient C, true iff TRUTH, makes or
+   breaks row R when its sum is S */
+#define pb_makes(R, S, TRUTH, C) ((S) < (R)->need && !(TRUTH) && (S) + (C) >= (R)->need)
+#define pb_breaks(R, S, TRUTH, C) ((S) >= (R)->need && (TRUTH) && (S) - (C) < (R)->need)
+
+
+int
+pb_parse_parameters(PROTO(char *) inputline)
+     /* Parse "pb FILE [offset]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    char word[MAXLINE];
+
+    pb_offset = 0;
+    word[0] = 0;
+    if (sscanf(inputline, " pb %s %s", pb_file, word) < 1){
+	crash_maybe(" Error: pb needs a file of rows\n");
+	return 0;
+    }
+    if (strcmp(word, "offset") == 0)
+      pb_offset = 1;
+    else if (word[0]){
+	sprintf(ss, " Error: unknown pb keyword %s\n", word);
+	crash_maybe(ss);
+    }
+    printf(" option: pseudo-Boolean rows from %s%s\n", pb_file,
+	   pb_offset ? ", vars numbered from 0" : "");
+    pb_window_visits = 0;
+    return 1;
+}
+
+void
+pb_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    if (pb_file[0])
+      fprintf(fp_report, "pb_file: %s\n", pb_file);
+    fprintf(fp_report, "pb_input_rows: %d\n", pb_num_input_rows);
+    fprintf(fp_report, "pb_rows: %d\n", pb_num_rows);
+    fprintf(fp_report, "pb_terms: %d\n", pb_num_terms);
+    fprintf(fp_report, "pb_false_rows: %d\n", pb_num_false);
+    fprintf(fp_report, "pb_window_visits: %d\n", pb_window_visits);
+}
+
+static int
+pb_compare_vars(PROTO(const void *) a, PROTO(const void *) b)
+PARAMS( const void * a; const void * b; )
+{
+    return ((const int *) a)[0] - ((const int *) b)[0];
+}
+
+static void
+pb_add_row(PROTO(int *) terms, PROTO(int) n, PROTO(int) sign, PROTO(int) need, PROTO(int) input_row)
+     /* Keep sign * sum of terms (var, coeff pairs) >= sign * need */
+PARAMS( int * terms; int n; int sign; int need; int input_row; )
+{
+    int i, c, total;
+    pb_row_ptr r;
+
+    need *= sign;
+    for (i = 0; i < n; i++)
+      if (sign * terms[2 * i + 1] < 0)
+	need -= sign * terms[2 * i + 1];	/* c x is -c (1 - x) - c */
+    if (need <= 0) return;
+
+    if (pb_num_rows >= pb_max_rows){
+	pb_max_rows = 2 * pb_max_rows + 64;
+	pb_row = (pb_row_ptr) realloc(pb_row, (size_t)(pb_max_rows * sizeof(struct pb_row_str)));
+    }
+    if (pb_num_terms + n > pb_max_terms){
+	pb_max_terms = 2 * (pb_num_terms + n) + 256;
+	pb_lit = (int *) realloc(pb_lit, (size_t)(pb_max_terms * sizeof(int)));
+	pb_coeff = (int *) realloc(pb_coeff, (size_t)(pb_max_terms * sizeof(int)));
+    }
+    if (pb_row == NULL || pb_lit == NULL || pb_coeff == NULL)
+      crash_and_burn("ERROR: cannot allocate pb rows\n");
+
+    r = &pb_row[pb_num_rows++];
+    r->need = need;
+    r->start = pb_num_terms;
+    r->len = 0;
+    r->max_coeff = 0;
+    r->input_row = input_row;
+    total = 0;
+    for (i = 0; i < n; i++){
+	if ((c = sign * terms[2 * i + 1]) == 0) continue;
+	pb_lit[pb_num_terms] = (c > 0) ? terms[2 * i] : -terms[2 * i];
+	c = abs_val(c);
+	if (c > need) c = need;		/* no more than need can count */
+	pb_coeff[pb_num_terms++] = c;
+	r->len++;
+	total += c;
+	if (c > r->max_coeff) r->max_coeff = c;
+    }
+    if (total < need)
+      printf("Warning!  pb row %d can never hold\n", input_row);
+}
+
+static int
+pb_read_relation(PROTO(FILE *) fp)
+     /* Returns the relation code, or -1 */
+PARAMS( FILE * fp; )
+{
+    char word[MAXLINE];
+    int i;
+    static char * names[] = { "between", "<=", ">=", "<", "=", ">" };
+
+    if (fscanf(fp, " %127s", word) != 1) return -1;
+    if (word[0] >= '0' && word[0] <= '9' && word[1] == 0)
+      return (word[0] - '0' <= PB_GREATER) ? word[0] - '0' : -1;
+    for (i = 0; i <= PB_GREATER; i++)
+      if (strcmp(word, names[i]) == 0) return i;
+    if (strcmp(word, "==") == 0) return PB_EQUAL;
+    return -1;
+}
+
+void
+pb_add_input_row(PROTO(int *) terms, PROTO(int) n, PROTO(int) reln, PROTO(int) c0, PROTO(int) c0upper)
+     /* Add a row of the input, whose terms are (internal var, coeff)
+	pairs; terms is reordered in place */
+PARAMS( int * terms; int n; int reln; int c0; int c0upper; )
+{
+    int i, j;
+
+    pb_num_input_rows++;
+
+    /* A var listed twice gets the sum of its coefficients */
+    qsort(terms, (size_t) n, 2 * sizeof(int), pb_compare_vars);
+    for (i = 0, j = -1; i < n; i++){
+	if (j >= 0 && terms[2 * j] == terms[2 * i])
+	  terms[2 * j + 1] += terms[2 * i + 1];
+	else {
+	    j++;
+	    terms[2 * j] = terms[2 * i];
+	    terms[2 * j + 1] = terms[2 * i + 1];
+	}
+    }
+    n = j + 1;
+
+    switch (reln){
+      case PB_GREATER:
+	c0++;
+	/* FALLTHROUGH */
+      case PB_GREATER_EQUAL:
+	pb_add_row(terms, n, 1, c0, pb_num_input_rows);
+	break;
+      case PB_LESS:
+	c0--;
+	/* FALLTHROUGH */
+      case PB_LESS_EQUAL:
+	pb_add_row(terms, n, -1, c0, pb_num_input_rows);
+	break;
+      case PB_EQUAL:
+	c0upper = c0;
+	/* FALLTHROUGH */
+      case PB_LOWER_UPPER:
+	pb_add_row(terms, n, 1, c0, pb_num_input_rows);
+	pb_add_row(terms, n, -1, c0upper, pb_num_input_rows);
+	break;
+      default:
+	sprintf(ss, "ERROR: bad relation %d in pb row %d\n", reln, pb_num_input_rows);
+	crash_and_burn(ss);
+    }
+}
+
+static void
+pb_read_file()
+{
+    FILE * fp;
+    int n, i, var, reln, c0, c0upper, max_terms;
+    int * terms;
+
+    if ((fp = fopen(pb_file, "r")) == NULL){
+	sprintf(ss, "ERROR: cannot open pb file %s\n", pb_file);
+	crash_and_burn(ss);
+    }
+
+    max_terms = 64;
+    terms = (int *) malloc((size_t)(2 * max_terms * sizeof(int)));
+    while (fscanf(fp, "%d", &n) == 1){
+	if (n < 0){
+	    sprintf(ss, "ERROR: bad length %d of pb row %d\n", n, pb_num_input_rows + 1);
+	    crash_and_burn(ss);
+	}
+	if (n > max_terms){
+	    max_terms = 2 * n;
+	    terms = (int *) realloc(terms, (size_t)(2 * max_terms * sizeof(int)));
+	}
+	if (terms == NULL)
+	  crash_and_burn("ERROR: cannot allocate pb rows\n");
+	for (i = 0; i < n; i++){
+	    if (fscanf(fp, "%d %d", &var, &terms[2 * i + 1]) != 2){
+		sprintf(ss, "ERROR: bad term in pb row %d\n", pb_num_input_rows + 1);
+		crash_and_burn(ss);
+	    }
+	    var += pb_offset;
+	    if (var < 1 || var > nvars){
+		sprintf(ss, "ERROR: var %d of pb row %d is not a var of the wff\n",
+			var - pb_offset, pb_num_input_rows + 1);
+		crash_and_burn(ss);
+	    }
+	    terms[2 * i] = internal_var(var);
+	}
+	c0upper = 0;
+	if ((reln = pb_read_relation(fp)) < 0 || fscanf(fp, "%d", &c0) != 1 ||
+	    (reln == PB_LOWER_UPPER && fscanf(fp, "%d", &c0upper) != 1)){
+	    sprintf(ss, "ERROR: bad relation in pb row %d\n", pb_num_input_rows + 1);
+	    crash_and_burn(ss);
+	}
+	pb_add_input_row(terms, n, reln, c0, c0upper);
+    }
+    if (!feof(fp)){
+	sprintf(ss, "ERROR: bad pb row %d\n", pb_num_input_rows + 1);
+	crash_and_burn(ss);
+    }
+    fclose(fp);
+    free((char *) terms);
+}
+
+void
+pb_read()
+     /* Read the rows and index them by var; called once the wff is read */
+{
+    int i, var, t;
+
+    if (flag_coloring || flag_novelty || flag_ccanr || flag_probsat || flag_paws)
+      crash_and_burn("ERROR: pb cannot be used with color, novelty, ccanr, probsat or paws\n");
+
+    pb_num_rows = pb_num_input_rows = pb_num_terms = 0;
+    pb_max_rows = pb_max_terms = 0;
+    if (flag_format == FLAG_FORMAT_NL)
+      ampl_read_rows();
+    if (pb_file[0])
+      pb_read_file();
+
+    /* Index the terms by var */
+    pb_term_row = (int *) malloc((size_t)((pb_num_terms + 1) * sizeof(int)));
+    pb_occ = (int *) malloc((size_t)((pb_num_terms + 1) * sizeof(int)));
+    pb_occ_start = (int *) malloc((size_t)((nvars + 2) * sizeof(int)));
+    if (pb_term_row == NULL || pb_occ == NULL || pb_occ_start == NULL)
+      crash_and_burn("ERROR: cannot allocate pb rows\n");
+    for (var = 0; var <= nvars + 1; var++) pb_occ_start[var] = 0;
+    for (i = 0; i < pb_num_rows; i++)
+      for (t = pb_row[i].start; t < pb_row[i].start + pb_row[i].len; t++){
+	  pb_term_row[t] = i;
+	  pb_occ_start[abs_val(pb_lit[t]) + 1]++;
+      }
+    for (var = 1; var <= nvars + 1; var++)
+      pb_occ_start[var] += pb_occ_start[var - 1];
+    for (t = 0; t < pb_num_terms; t++)
+      pb_occ[pb_occ_start[abs_val(pb_lit[t])]++] = t;
+    for (var = nvars + 1; var > 0; var--)
+      pb_occ_start[var] = pb_occ_start[var - 1];
+    pb_occ_start[0] = 0;
+
+    printf("pb rows = %d\npb terms = %d\n", pb_num_rows, pb_num_terms);
+}
+
+int
+pb_occurs(PROTO(int) var)
+     /* 1 iff var is in some row */
+PARAMS( int var; )
+{
+    return pb_occ_start[var + 1] > pb_occ_start[var];
+}
+
+void
+pb_init_diff()
+     /* Add the rows' makes and breaks to the diffs, as init_diff does
+	for the clauses */
+{
+    int i, t, truth;
+    pb_row_ptr r;
+    var_str_ptr var_ptr;
+
+    pb_num_false = 0;
+    for (i = 0, r = pb_row; i < pb_num_rows; i++, r++){
+	r->sum = 0;
+	for (t = r->start; t < r->start + r->len; t++)
+	  if (same_sign(assign[abs_val(pb_lit[t])].value, pb_lit[t]))
+	    r->sum += pb_coeff[t];
+	if (r->sum < r->need) pb_num_false++;
+	if (r->sum >= r->need + r->max_coeff || r->sum < r->need - r->max_coeff)
+	  continue;
+	for (t = r->start; t < r->start + r->len; t++){
+	    var_ptr = &assign[abs_val(pb_lit[t])];
+	    truth = same_sign(var_ptr->value, pb_lit[t]);
+	    if (pb_makes(r, r->sum, truth, pb_coeff[t])){
+		var_ptr->diff++;
+		var_ptr->make++;
+	    }
+	    else if (pb_breaks(r, r->sum, truth, pb_coeff[t]))
+	      var_ptr->diff--;
+	}
+    }
+}
+
+void
+pb_update_diff(PROTO(int) var)
+     /* Called by update_diff once var has been flipped: update the sums
+	of var's rows, current_num_bad, and the diffs of the members of
+	rows whose sum moved within the window.  var's own bucket is left
+	to update_diff. */
+PARAMS( int var; )
+{
+    int o, t, u, old_sum, new_sum, truth, was_true, c, d_make, d_break;
+    pb_row_ptr r;
+    var_str_ptr var_ptr;
+
+    for (o = pb_occ_start[var]; o < pb_occ_start[var + 1]; o++){
+	t = pb_occ[o];
+	r = &pb_row[pb_term_row[t]];
+	old_sum = r->sum;
+	new_sum = same_sign(assign[var].value, pb_lit[t])
+	  ? old_sum + pb_coeff[t] : old_sum - pb_coeff[t];
+	r->sum = new_sum;
+
+	if (old_sum < r->need && new_sum >= r->need){
+	    pb_num_false--;
+	    current_num_bad--;
+	}
+	else if (old_sum >= r->need && new_sum < r->need){
+	    pb_num_false++;
+	    current_num_bad++;
+	}
+
+	if ((old_sum >= r->need + r->max_coeff || old_sum < r->need - r->max_coeff) &&
+	    (new_sum >= r->need + r->max_coeff || new_sum < r->need - r->max_coeff))
+	  continue;
+	pb_window_visits++;
+
+	for (u = r->start; u < r->start + r->len; u++){
+	    var_ptr = &assign[abs_val(pb_lit[u])];
+	    truth = same_sign(var_ptr->value, pb_lit[u]);
+	    was_true = (u == t) ? !truth : truth;
+	    c = pb_coeff[u];
+	    d_make = pb_makes(r, new_sum, truth, c) - pb_makes(r, old_sum, was_true, c);
+	    d_break = pb_breaks(r, new_sum, truth, c) - pb_breaks(r, old_sum, was_true, c);
+	    if (d_make || d_break){
+		var_ptr->diff += d_make - d_break;
+		var_ptr->make += d_make;
+		if (u != t) adjust_bucket(var_ptr);
+	    }
+	}
+    }
+}
+
+int
+pb_count_bad(PROTO(int) print_flag, PROTO(int) best_flag)
+     /* Number of false rows, checked from scratch, under the current
+	assignment, or the best one if best_flag */
+PARAMS( int print_flag; int best_flag; )
+{
+    int i, t, sum, num_bad;
+    pb_row_ptr r;
+    var_str_ptr var_ptr;
+
+    num_bad = 0;
+    for (i = 0, r = pb_row; i < pb_num_rows; i++, r++){
+	sum = 0;
+	for (t = r->start; t < r->start + r->len; t++){
+	    var_ptr = &assign[abs_val(pb_lit[t])];
+	    if (same_sign(best_flag ? var_ptr->value_best : var_ptr->value, pb_lit[t]))
+	      sum += pb_coeff[t];
+	}
+	if (sum < r->need){
+	    num_bad++;
+	    if (print_flag && num_bad <= MAX_DIAGNOSTICS)
+	      printf("Unsat pb row %d has sum %d < %d\n", r->input_row, sum, r->need);
+	}
+    }
+    return num_bad;
+}
+
+void
+pb_checkpoint()
+     /* The rows are read again; only the count carries on */
+{
+    checkpoint_data((char *) &pb_window_visits, (long) sizeof(int));
+}
+
+void
+pb_checkpoint_try()
+     /* The sums of the rows under the current assignment */
+{
+    int i;
+
+    for (i = 0; i < pb_num_rows; i++)
+      checkpoint_data((char *) &pb_row[i].sum, (long) sizeof(int));
+    checkpoint_data((char *) &pb_num_false, (long) sizeof(int));
+}
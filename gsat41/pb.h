@@ -0,0 +1,32 @@
+/* pb.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef PB_H
+#define PB_H
+#include "proto.h"
+
+extern
+int pb_num_false;		/* pseudo-Boolean rows that are false now */
+
+EXTERN_FUNCTION( int pb_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void pb_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void pb_read, ());
+EXTERN_FUNCTION( void pb_add_input_row, (int * terms, int n, int reln, int c0, int c0upper));
+EXTERN_FUNCTION( int pb_occurs, (int var));
+EXTERN_FUNCTION( void pb_init_diff, ());
+EXTERN_FUNCTION( void pb_update_diff, (int var));
+EXTERN_FUNCTION( int pb_count_bad, (int print_flag, int best_flag));
+EXTERN_FUNCTION( void pb_checkpoint, ());
+EXTERN_FUNCTION( void pb_checkpoint_try, ());
+
+#endif
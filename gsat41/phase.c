@@ -0,0 +1,222 @@
+/* phase.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Phase timers.  experiment_seconds is user time from the end of
+   initialization, so it leaves out reading the wff, and says nothing
+   of where the time of a try goes.  With this option each phase of
+   the run (see phase.h) is timed by the wall clock from phase_begin to
+   phase_end, and the report gives its calls and total seconds.  Phases
+   nest: init_experiment includes read_in and init_pointers, and
+   init_try includes init_assign_values, init_diff and init_buckets.
+   Time in search is spent flipping; time in init_try and try_stats
+   is the cost of restarts.
+
+   With "phases counters", on Linux, four hardware counters are also
+   read at each phase_begin and phase_end through perf_event_open:
+   cycles, instructions, last level cache misses and branch misses,
+   counting this process in user mode only.  They are opened as one
+   group, so they count over the same intervals.  A search with few
+   instructions per cycle and many cache misses per flip is waiting on
+   memory, in update_diff and the bucket moves; if the counters cannot
+   be opened (e.g. perf_event_paranoid forbids it) only times are
+   given. */
+
+#include "gsat.h"
+#include "phase.h"
+#include "utils.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PHASE_PERF 1
+
+EXTERN_FUNCTION( long syscall, (long number, ...));
+EXTERN_FUNCTION( int close, (int fd));
+EXTERN_FUNCTION( long read, (int fd, void * buf, unsigned long n));
+#endif
+
+#define PHASE_COUNTERS 4
+
+typedef unsigned long long phase_count;
+
+static char * phase_names[PHASES] = {
+    "init_experiment", "read_in", "init_pointers", "init_try",
+    "init_assign_values", "init_diff", "init_buckets", "search",
+    "try_stats", "wrapup" };
+
+static char * phase_counter_names[PHASE_COUNTERS] = {
+    "cycles", "instructions", "llc_misses", "branch_misses" };
+
+int phase_counters;		/* 1 = counters requested and opened */
+int phase_fd = -1;		/* leader of the counter group */
+double phase_origin;		/* clock when the option was read */
+long phase_calls[PHASES];
+double phase_started[PHASES];
+double phase_seconds[PHASES];
+phase_count phase_start_count[PHASES][PHASE_COUNTERS];
+phase_count phase_total[PHASES][PHASE_COUNTERS];
+
+
+static double
+phase_clock()
+     /* Wall clock seconds */
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+#ifdef PHASE_PERF
+static int
+phase_open(PROTO(unsigned) type, PROTO(unsigned long long) config, PROTO(int) group)
+     /* Open one counter of this process, in the group of leader group */
+PARAMS( unsigned type; unsigned long long config; int group; )
+{
+    struct perf_event_attr attr;
+
+    memset((char *) &attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.disabled = (group < 0);
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+static void
+phase_open_counters()
+{
+    static unsigned long long configs[PHASE_COUNTERS] = {
+	PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    int i;
+
+    phase_fd = phase_open(PERF_TYPE_HARDWARE, configs[0], -1);
+    for (i = 1; i < PHASE_COUNTERS && phase_fd >= 0; i++)
+      if (phase_open(PERF_TYPE_HARDWARE, configs[i], phase_fd) < 0){
+	  close(phase_fd);
+	  phase_fd = -1;
+      }
+    if (phase_fd < 0){
+	printf("         hardware counters not available, timing only\n");
+	phase_counters = 0;
+	return;
+    }
+    ioctl(phase_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+#endif
+
+static void
+phase_read(PROTO(phase_count *) counts)
+     /* Read the counter group into counts */
+PARAMS( phase_count * counts; )
+{
+#ifdef PHASE_PERF
+    phase_count buf[1 + PHASE_COUNTERS];
+    int i;
+
+    if (read(phase_fd, (char *) buf, sizeof(buf)) != sizeof(buf)) {
+	for (i = 0; i < PHASE_COUNTERS; i++) counts[i] = 0;
+	return;
+    }
+    for (i = 0; i < PHASE_COUNTERS; i++) counts[i] = buf[1 + i];
+#endif
+}
+
+
+int
+phase_parse_parameters(PROTO(char *) inputline)
+     /* Parse "phases [counters]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    char word[MAXLINE];
+
+    word[0] = 0;
+    sscanf(inputline, " phases %s", word);
+    phase_counters = 0;
+    if (strcmp(word, "counters") == 0)
+      phase_counters = 1;
+    else if (word[0] != 0){
+	sprintf(ss, " Error: unknown phases argument %s\n", word);
+	crash_maybe(ss);
+	return 0;
+    }
+    printf(" option: time phases%s\n", phase_counters ? ", with hardware counters" : "");
+#ifdef PHASE_PERF
+    if (phase_counters && phase_fd < 0) phase_open_counters();
+#else
+    if (phase_counters){
+	printf("         hardware counters not available, timing only\n");
+	phase_counters = 0;
+    }
+#endif
+    phase_origin = phase_clock();
+    return 1;
+}
+
+void
+phase_begin(PROTO(int) phase)
+PARAMS( int phase; )
+{
+    if (phase_counters) phase_read(phase_start_count[phase]);
+    phase_started[phase] = phase_clock();
+}
+
+void
+phase_end(PROTO(int) phase)
+PARAMS( int phase; )
+{
+    phase_count counts[PHASE_COUNTERS];
+    int i;
+
+    phase_seconds[phase] += phase_clock() - phase_started[phase];
+    phase_calls[phase]++;
+    if (phase_counters){
+	phase_read(counts);
+	for (i = 0; i < PHASE_COUNTERS; i++)
+	  phase_total[phase][i] += counts[i] - phase_start_count[phase][i];
+    }
+}
+
+void
+phase_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    int p, i;
+
+    fprintf(fp_report, "phase_run_seconds (wall clock since the options): %f\n",
+	    phase_clock() - phase_origin);
+    for (p = 0; p < PHASES; p++){
+	if (phase_calls[p] == 0) continue;
+	fprintf(fp_report, "PHASE %s: calls=%ld, seconds=%f",
+		phase_names[p], phase_calls[p], phase_seconds[p]);
+	if (phase_counters){
+	    for (i = 0; i < PHASE_COUNTERS; i++)
+	      fprintf(fp_report, ", %s=%llu", phase_counter_names[i], phase_total[p][i]);
+	    if (phase_total[p][0] > 0)
+	      fprintf(fp_report, ", ipc=%.3f",
+		      (double) phase_total[p][1] / (double) phase_total[p][0]);
+	}
+	fprintf(fp_report, "\n");
+    }
+    if (phase_counters && total_sum_flips > 0 && phase_calls[PHASE_SEARCH] > 0){
+	for (i = 0; i < PHASE_COUNTERS; i++)
+	  fprintf(fp_report, "search_%s_per_flip: %f\n", phase_counter_names[i],
+		  (double) phase_total[PHASE_SEARCH][i] / total_sum_flips);
+    }
+    fprintf(fp_report, "\n");
+}
@@ -0,0 +1,36 @@
+/* phase.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef PHASE_H
+#define PHASE_H
+#include "proto.h"
+
+/* Timed phases; a phase may run inside another (see phase.c) */
+#define PHASE_INIT_EXPERIMENT 0
+#define PHASE_READ_IN 1
+#define PHASE_INIT_POINTERS 2
+#define PHASE_INIT_TRY 3
+#define PHASE_INIT_ASSIGN 4
+#define PHASE_INIT_DIFF 5
+#define PHASE_INIT_BUCKETS 6
+#define PHASE_SEARCH 7
+#define PHASE_TRY_STATS 8
+#define PHASE_WRAPUP 9
+#define PHASES 10
+
+EXTERN_FUNCTION( int phase_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void phase_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void phase_begin, (int phase));
+EXTERN_FUNCTION( void phase_end, (int phase));
+
+#endif
@@ -0,0 +1,256 @@
+/* population.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Population of elite assignments.  The "r" option averages the best
+   assignments of the previous two tries; this keeps the best
+   assignments of up to P tries instead, one bit per var, and makes
+   each new start by crossover of K of them: every var takes its value
+   from a random one of the K parents.  With K = 2 this is the
+   averaging of the "r" option.
+
+   At the end of each try the try's best assignment enters the pool.
+   To keep the pool diverse, the member nearest to it in Hamming
+   distance is found first; if that one is closer than population_dist
+   the newcomer replaces it only if it has no more bad clauses, and is
+   dropped otherwise.  A newcomer that is far from every member fills
+   an empty slot or replaces the worst member.  Starts are random until
+   the pool is full. */
+
+#include "gsat.h"
+#include "population.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define POPULATION_SIZE_DEFAULT 10
+#define POPULATION_PARENTS_DEFAULT 3
+#define POPULATION_WORD_BITS ((int)(8 * sizeof(unsigned long)))
+
+#define population_member(M) (&population_bits[(M) * population_words])
+
+int population_size;		/* P, the most members kept */
+int population_parents;		/* K, the parents of each start */
+int population_dist;		/* closer members compete; 0 = nvars / 100 */
+int population_words;		/* unsigned longs per member */
+unsigned long *population_bits = NULL;	/* members 0..P-1, then a scratch member */
+int *population_bad = NULL;	/* num_bad of each member */
+int *population_pick = NULL;	/* parents are population_pick[0..K-1] */
+int population_count;		/* members so far */
+int population_crossovers;	/* starts made by crossover */
+int population_inserts;		/* tries that filled or replaced a slot */
+int population_crowded;		/* tries that replaced a near member */
+int population_rejected;	/* tries that were dropped */
+
+
+int
+population_parse_parameters(PROTO(char *) inputline)
+     /* Parse "population [P [K [D]]]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    population_size = POPULATION_SIZE_DEFAULT;
+    population_parents = POPULATION_PARENTS_DEFAULT;
+    population_dist = 0;
+    sscanf(inputline, " population %d %d %d", &population_size,
+	   &population_parents, &population_dist);
+    if (population_size < 2 || population_parents < 2 ||
+	population_parents > population_size || population_dist < 0){
+	crash_maybe(" Error: population needs 2 <= K <= P and D >= 0\n");
+	population_size = POPULATION_SIZE_DEFAULT;
+	population_parents = POPULATION_PARENTS_DEFAULT;
+	population_dist = 0;
+    }
+    if (population_dist > 0)
+      printf(" option: population of %d, %d parents, distance %d\n",
+	     population_size, population_parents, population_dist);
+    else
+      printf(" option: population of %d, %d parents, default distance\n",
+	     population_size, population_parents);
+    population_count = 0;
+    population_crossovers = 0;
+    population_inserts = 0;
+    population_crowded = 0;
+    population_rejected = 0;
+    return 1;
+}
+
+static int
+population_bit_count(PROTO(unsigned long) w)
+PARAMS( unsigned long w; )
+{
+    int n;
+
+    for (n = 0; w; n++)
+      w &= w - 1;
+    return n;
+}
+
+static int
+population_distance(PROTO(unsigned long *) a, PROTO(unsigned long *) b)
+     /* Hamming distance of two members */
+PARAMS( unsigned long * a; unsigned long * b; )
+{
+    int w, d;
+
+    d = 0;
+    for (w = 0; w < population_words; w++)
+      d += population_bit_count(a[w] ^ b[w]);
+    return d;
+}
+
+void
+population_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    int m, n, best, worst;
+    double sum;
+
+    fprintf(fp_report, "flag_population: %d\n", flag_population);
+    fprintf(fp_report, "population_size: %d\n", population_size);
+    fprintf(fp_report, "population_parents: %d\n", population_parents);
+    fprintf(fp_report, "population_distance: %d\n", population_dist);
+    fprintf(fp_report, "population_count: %d\n", population_count);
+    fprintf(fp_report, "population_crossovers: %d\n", population_crossovers);
+    fprintf(fp_report, "population_inserts: %d\n", population_inserts);
+    fprintf(fp_report, "population_crowded: %d\n", population_crowded);
+    fprintf(fp_report, "population_rejected: %d\n", population_rejected);
+    if (population_count < 2) return;
+
+    best = worst = population_bad[0];
+    sum = 0.0;
+    for (m = 0; m < population_count; m++){
+	if (population_bad[m] < best) best = population_bad[m];
+	if (population_bad[m] > worst) worst = population_bad[m];
+	for (n = m + 1; n < population_count; n++)
+	  sum += population_distance(population_member(m), population_member(n));
+    }
+    fprintf(fp_report, "population_best_bad: %d\n", best);
+    fprintf(fp_report, "population_worst_bad: %d\n", worst);
+    fprintf(fp_report, "population_mean_distance: %f\n",
+	    sum / ((double)population_count * (population_count - 1) / 2));
+}
+
+static void
+population_allocate()
+{
+    population_words = (nvars + POPULATION_WORD_BITS) / POPULATION_WORD_BITS;
+    population_bits = (unsigned long *)
+      malloc((size_t)((population_size + 1) * population_words * sizeof(unsigned long)));
+    population_bad = (int *) malloc((size_t)(population_size * sizeof(int)));
+    population_pick = (int *) malloc((size_t)(population_size * sizeof(int)));
+    if (population_bits == NULL || population_bad == NULL || population_pick == NULL)
+      crash_and_burn("ERROR: cannot allocate population\n");
+    if (population_dist <= 0)
+      population_dist = nvars / 100;
+}
+
+int
+population_init_values()
+     /* Make the start of a try by crossover; returns 0, leaving the
+	start to init_assign_values, until the pool is full */
+{
+    unsigned long *p;
+    int i, j, tmp;
+    var_str_ptr var_ptr;
+
+    if (population_count < population_size) return 0;
+
+    /* K distinct parents, by a partial shuffle */
+    for (i = 0; i < population_size; i++) population_pick[i] = i;
+    for (i = 0; i < population_parents; i++){
+	j = i + random_1_to(population_size - i) - 1;
+	tmp = population_pick[i];
+	population_pick[i] = population_pick[j];
+	population_pick[j] = tmp;
+    }
+
+    for (i = 1, var_ptr = &assign[1]; i <= nvars; i++, var_ptr++){
+	p = population_member(population_pick[random_1_to(population_parents) - 1]);
+	var_ptr->value = ((p[i / POPULATION_WORD_BITS] >> (i % POPULATION_WORD_BITS)) & 1) ? 1 : -1;
+	var_ptr->value_low = var_ptr->prev_low = var_ptr->value;
+	if (flag_graphics) graphics_show_variable(i, 0);
+    }
+    population_crossovers++;
+    return 1;
+}
+
+void
+population_end_try(PROTO(int) num_bad)
+     /* Offer the best assignment of the try, which has num_bad bad
+	clauses, to the pool */
+PARAMS( int num_bad; )
+{
+    unsigned long *c;
+    int i, m, d, near, near_dist, worst;
+    var_str_ptr var_ptr;
+
+    if (population_bits == NULL) population_allocate();
+
+    c = population_member(population_size);
+    for (i = 0; i < population_words; i++) c[i] = 0;
+    for (i = 1, var_ptr = &assign[1]; i <= nvars; i++, var_ptr++)
+      if (var_ptr->value_low > 0)
+	c[i / POPULATION_WORD_BITS] |= 1UL << (i % POPULATION_WORD_BITS);
+
+    near = -1;
+    near_dist = BIG;
+    for (m = 0; m < population_count; m++){
+	d = population_distance(c, population_member(m));
+	if (d < near_dist){
+	    near = m;
+	    near_dist = d;
+	}
+    }
+
+    if (near >= 0 && near_dist < population_dist){
+	if (num_bad > population_bad[near]){
+	    population_rejected++;
+	    return;
+	}
+	m = near;
+	population_crowded++;
+    }
+    else if (population_count < population_size){
+	m = population_count++;
+	population_inserts++;
+    }
+    else {
+	worst = 0;
+	for (m = 1; m < population_count; m++)
+	  if (population_bad[m] >= population_bad[worst]) worst = m;
+	if (num_bad > population_bad[worst]){
+	    population_rejected++;
+	    return;
+	}
+	m = worst;
+	population_inserts++;
+    }
+
+    for (i = 0; i < population_words; i++)
+      population_member(m)[i] = c[i];
+    population_bad[m] = num_bad;
+}
+
+void
+population_checkpoint()
+     /* The pool and its counts */
+{
+    checkpoint_data((char *) &population_count, (long) sizeof(int));
+    checkpoint_data((char *) &population_crossovers, (long) sizeof(int));
+    checkpoint_data((char *) &population_inserts, (long) sizeof(int));
+    checkpoint_data((char *) &population_crowded, (long) sizeof(int));
+    checkpoint_data((char *) &population_rejected, (long) sizeof(int));
+    if (population_count == 0) return;
+    if (population_bits == NULL) population_allocate();
+    checkpoint_data((char *) population_bits,
+		    (long) (population_count * population_words * sizeof(unsigned long)));
+    checkpoint_data((char *) population_bad, (long) (population_count * sizeof(int)));
+}
@@ -0,0 +1,136 @@
+/* probsat.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* probSAT picks (Balint & Schoning, "Choosing probability
+   distributions for stochastic local search and the role of make
+   versus break").  Each flip chooses a random false clause and flips
+   one of its vars with probability proportional to f(break), where
+   break = make - diff is the (weighted) number of clauses the flip
+   would make false, and f is
+
+	poly:	(PROBSAT_EPS + break) ^ -cb
+	exp:	cb ^ -break
+
+   f is tabulated once, as integers scaled by PROBSAT_SCALE, for
+   breaks up to PROBSAT_TABLE_SIZE - 1; larger breaks use the last
+   entry.  A pick is then two passes over the clause with integer
+   arithmetic only. */
+
+#include <math.h>
+#include "gsat.h"
+#include "probsat.h"
+#include "utils.h"
+
+#define PROBSAT_TABLE_SIZE 64
+#define PROBSAT_SCALE 65536	/* table entry for f = 1 */
+#define PROBSAT_EPS 1.0
+#define PROBSAT_CB_POLY 2.38	/* defaults tuned for random 3-SAT */
+#define PROBSAT_CB_EXP 2.5
+
+float probsat_cb;
+int probsat_exp;		/* 1 = exponential, 0 = polynomial */
+int probsat_table[PROBSAT_TABLE_SIZE];
+
+
+int
+probsat_parse_parameters(PROTO(char *) inputline)
+     /* Parse "probsat [CB [poly|exp]]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    char word[100];
+
+    probsat_cb = 0.0;
+    word[0] = 0;
+    sscanf(inputline, " probsat %f %s", &probsat_cb, word);
+    probsat_exp = (strcmp(word, "exp") == 0);
+    if (word[0] && !probsat_exp && strcmp(word, "poly") != 0){
+	sprintf(ss, " Error: unknown probsat function %s\n", word);
+	crash_maybe(ss);
+    }
+    if (probsat_cb <= 0.0)
+      probsat_cb = probsat_exp ? PROBSAT_CB_EXP : PROBSAT_CB_POLY;
+    if (probsat_exp && probsat_cb <= 1.0){
+	crash_maybe(" Error: probsat exp base must be greater than 1\n");
+	probsat_cb = PROBSAT_CB_EXP;
+    }
+    printf(" option: probsat, %s cb = %f\n", probsat_exp ? "exp" : "poly", probsat_cb);
+    probsat_make_table();
+    return 1;
+}
+
+void
+probsat_make_table()
+     /* Tabulate f(break), never letting an entry reach 0 */
+{
+    int b;
+    double f;
+
+    for (b = 0; b < PROBSAT_TABLE_SIZE; b++){
+	if (probsat_exp)
+	  f = pow((double)probsat_cb, -(double)b);
+	else
+	  f = pow(PROBSAT_EPS + b, -(double)probsat_cb);
+	probsat_table[b] = (int)(f * PROBSAT_SCALE);
+	if (probsat_table[b] < 1) probsat_table[b] = 1;
+    }
+}
+
+void
+probsat_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_probsat: %d\n", flag_probsat);
+    fprintf(fp_report, "probsat_function: %s\n", probsat_exp ? "exp" : "poly");
+    fprintf(fp_report, "probsat_cb: %f\n", probsat_cb);
+}
+
+void
+probsat_initialize()
+     /* Called at the start of each try, after init_diff has built the
+	false clause list */
+{
+    if (flag_coloring)
+      crash_and_burn("ERROR: probsat cannot be used with the color option\n");
+}
+
+#define probsat_f(VARPTR) \
+  (((VARPTR)->make - (VARPTR)->diff) < PROBSAT_TABLE_SIZE ? \
+   probsat_table[(VARPTR)->make - (VARPTR)->diff] : probsat_table[PROBSAT_TABLE_SIZE - 1])
+
+int
+probsat_pick_var()
+     /* Pick a var of a random false clause; 0 if there are none */
+{
+    wff_str_ptr clause_ptr;
+    var_str_ptr vp;
+    int j, clause_len, sum, r;
+
+    if (num_false_clauses == 0) return 0;
+
+    clause_ptr = &wff[false_clause[random_1_to(num_false_clauses)]];
+    clause_len = clause_ptr->lit;
+
+    sum = 0;
+    for (j = 1; j <= clause_len; j++){
+	vp = &assign[abs_val(clause_ptr[j].lit)];
+	sum += probsat_f(vp);
+    }
+
+    r = random_1_to(sum);
+    for (j = 1; j < clause_len; j++){
+	vp = &assign[abs_val(clause_ptr[j].lit)];
+	if ((r -= probsat_f(vp)) <= 0)
+	  break;
+    }
+    return abs_val(clause_ptr[j].lit);
+}
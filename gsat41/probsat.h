@@ -0,0 +1,24 @@
+/* probsat.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef PROBSAT_H
+#define PROBSAT_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int probsat_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void probsat_make_table, ());
+EXTERN_FUNCTION( void probsat_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void probsat_initialize, ());
+EXTERN_FUNCTION( int probsat_pick_var, ());
+
+#endif
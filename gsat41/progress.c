@@ -0,0 +1,439 @@
+/* progress.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Live progress.  Sending gsat SIGUSR1 writes a snapshot of its
+   progress to stderr as one line of JSON, and the run goes on as if
+   nothing had happened; unlike the interrupt handler it neither asks
+   nor writes the report.  The handler only sets a flag; the snapshot
+   is made by progress_service at the next flip or try, with SIGVTALRM
+   blocked, so that it never runs inside a slot update.
+
+   With "progress [ADDRESS]" the snapshot is kept up to date in a
+   board in anonymous shared memory, with one slot per process: the
+   parent and, with the elite option, each worker.  A slot is written
+   only by its own process, from a SIGVTALRM handler every
+   PROGRESS_USECS of CPU time, so the flip loop is untouched; the
+   handler copies flip, current_num_bad, low_bad and best_num_bad and
+   works out the flip rate.  Each slot carries a sequence number that
+   is odd while the slot is being written, so a reader in another
+   process copies the slot and tries again if the number was odd or
+   has changed, and no locks are taken.  The two handlers are installed
+   with sigaction so that each blocks the other.  (Tempering replicas do not get slots; as in the report,
+   the first replica stands for the try.)
+
+   With an ADDRESS, a server process forked at the start listens
+   there, PORT on the loopback interface, HOST:PORT, or a path
+   containing '/' for a Unix socket, and answers each connection with
+   the JSON snapshot of the board as an HTTP/1.0 response, so that
+   e.g. "curl localhost:PORT" or "curl --unix-socket PATH http://x/"
+   can watch a run.  The server exits when gsat finishes or dies. */
+
+#include "gsat.h"
+#include "progress.h"
+#include "cluster.h"
+#include "utils.h"
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <time.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+EXTERN_FUNCTION( int fork, (void));
+EXTERN_FUNCTION( int getpid, (void));
+EXTERN_FUNCTION( int getppid, (void));
+EXTERN_FUNCTION( int close, (int fd));
+EXTERN_FUNCTION( long read, (int fd, void * buf, unsigned long n));
+EXTERN_FUNCTION( long write, (int fd, const void * buf, unsigned long n));
+EXTERN_FUNCTION( void _exit, (int status));
+
+extern int elite_workers;
+
+#define PROGRESS_MAX_PROCS 64	/* as many as elite workers */
+#define PROGRESS_USECS 250000	/* CPU time between slot updates */
+#define PROGRESS_WAIT_USECS 200000	/* the server waits this long for a request */
+#define PROGRESS_BUFFER 32768
+
+#ifdef __GNUC__
+#define progress_barrier() __sync_synchronize()
+#else
+#define progress_barrier()
+#endif
+
+struct progress_slot_str {
+    volatile unsigned seq;	/* odd while being written */
+    int pid;
+    int try;
+    int flip;
+    int num_bad;		/* current_num_bad */
+    int low_bad;		/* of the try, BIG before the first flip */
+    int best_num_bad;		/* BIG before the first try ends */
+    int updates;
+    double flips;		/* total over all tries */
+    double flips_per_second;
+    double when;		/* wall clock of the update */
+};
+
+struct progress_board_str {
+    volatile int stop;		/* 1 = gsat has finished */
+    int procs;			/* slots in use */
+    double started;		/* wall clock at progress_start */
+    struct progress_slot_str slot[PROGRESS_MAX_PROCS];
+};
+
+char progress_address[MAXLINE];	/* empty = no server */
+struct progress_board_str progress_local;	/* the board without the option */
+struct progress_board_str *progress_board = &progress_local;
+int progress_proc;		/* this process's slot */
+int progress_server_pid = -1;
+int progress_snapshots;		/* SIGUSR1 snapshots written */
+volatile sig_atomic_t progress_requested;	/* 1 = SIGUSR1 awaits a snapshot */
+double progress_prev_flips, progress_prev_when;
+char progress_buffer[PROGRESS_BUFFER];
+
+
+static double
+progress_clock()
+     /* Wall clock seconds; clock_gettime may be called from a handler */
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+typedef void (*progress_handler_ptr)();
+
+static void
+progress_handle(PROTO(int) sig, PROTO(progress_handler_ptr) handler, PROTO(int) other)
+     /* Install handler for sig, blocking signal other while it runs */
+PARAMS( int sig; progress_handler_ptr handler; int other; )
+{
+    struct sigaction sa;
+
+    memset((char *) &sa, 0, sizeof(sa));
+    sa.sa_handler = (void (*)(int)) handler;
+    sigemptyset(&sa.sa_mask);
+    sigaddset(&sa.sa_mask, other);
+    sa.sa_flags = SA_RESTART;
+    sigaction(sig, &sa, NULL);
+}
+
+int
+progress_parse_parameters(PROTO(char *) inputline)
+     /* Parse "progress [ADDRESS]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    progress_address[0] = 0;
+    sscanf(inputline, " progress %s", progress_address);
+    if (progress_address[0])
+      printf(" option: progress board, served at %s\n", progress_address);
+    else
+      printf(" option: progress board\n");
+    return 1;
+}
+
+void
+progress_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_progress: %d\n", flag_progress);
+    if (progress_address[0])
+      fprintf(fp_report, "progress_address: %s\n", progress_address);
+    fprintf(fp_report, "progress_snapshots: %d\n", progress_snapshots);
+}
+
+static void
+progress_update()
+     /* Copy this process's state into its slot */
+{
+    struct progress_slot_str *s;
+    double now, flips;
+
+    s = &progress_board->slot[progress_proc];
+    now = progress_clock();
+    flips = (double) total_sum_flips + flip;
+    s->seq++;
+    progress_barrier();
+    s->pid = getpid();
+    s->try = current_try;
+    s->flip = flip;
+    s->num_bad = current_num_bad;
+    s->low_bad = (current_num_bad < low_bad) ? current_num_bad : low_bad;
+    s->best_num_bad = best_num_bad;
+    if (s->updates > 0 && now > progress_prev_when && flips >= progress_prev_flips)
+      s->flips_per_second = (flips - progress_prev_flips) / (now - progress_prev_when);
+    s->flips = flips;
+    s->when = now;
+    s->updates++;
+    progress_barrier();
+    s->seq++;
+    progress_prev_flips = flips;
+    progress_prev_when = now;
+}
+
+static void
+progress_tick(PROTO(int) sig)
+     /* SIGVTALRM: bring this process's slot up to date */
+PARAMS( int sig; )
+{
+    progress_update();
+}
+
+static void
+progress_read_slot(PROTO(int) proc, PROTO(struct progress_slot_str *) copy)
+     /* Copy a slot written by another process; this process's own slot
+	is copied directly, as SIGVTALRM is blocked while it is read */
+PARAMS( int proc; struct progress_slot_str * copy; )
+{
+    struct progress_slot_str *s;
+    unsigned seq;
+
+    s = &progress_board->slot[proc];
+    if (proc == progress_proc){
+	memcpy((char *) copy, (char *) s, sizeof(*copy));
+	return;
+    }
+    do {
+	seq = s->seq;
+	progress_barrier();
+	memcpy((char *) copy, (char *) s, sizeof(*copy));
+	progress_barrier();
+    } while ((seq & 1) || s->seq != seq);
+}
+
+static char *
+progress_int(PROTO(char *) p, PROTO(char *) name, PROTO(int) value)
+     /* Append "name":value, or null for BIG */
+PARAMS( char * p; char * name; int value; )
+{
+    if (value == BIG)
+      sprintf(p, ",\"%s\":null", name);
+    else
+      sprintf(p, ",\"%s\":%d", name, value);
+    return p + strlen(p);
+}
+
+static int
+progress_json(PROTO(char *) buf)
+     /* Write the board as JSON into buf; returns its length */
+PARAMS( char * buf; )
+{
+    struct progress_slot_str s;
+    char *p, *w;
+    double now, flips, rate;
+    int proc, best;
+
+    now = progress_clock();
+    flips = 0;
+    rate = 0;
+    best = BIG;
+    p = buf;
+    sprintf(p, "{\"wff_file\":\"");
+    p += strlen(p);
+    for (w = wff_file; *w && p < buf + MAXLINE; w++){
+	if (*w == '"' || *w == '\\') *p++ = '\\';
+	*p++ = *w;
+    }
+    sprintf(p, "\",\"nvars\":%d,\"nclauses\":%d,\"max_flips\":%d,\"max_tries\":%d,"
+	    "\"seconds\":%.3f,\"procs\":[",
+	    nvars, nclauses, max_flips, max_tries, now - progress_board->started);
+    p += strlen(p);
+    for (proc = 0; proc < progress_board->procs; proc++){
+	progress_read_slot(proc, &s);
+	if (s.updates == 0) continue;
+	flips += s.flips;
+	rate += s.flips_per_second;
+	if (s.best_num_bad < best) best = s.best_num_bad;
+	if (s.low_bad < best) best = s.low_bad;
+	sprintf(p, "%s{\"proc\":%d,\"pid\":%d,\"try\":%d,\"flip\":%d,\"flips\":%.0f,"
+		"\"flips_per_second\":%.1f,\"num_bad\":%d",
+		(p[-1] == '[') ? "" : ",", proc, s.pid, s.try, s.flip, s.flips,
+		s.flips_per_second, s.num_bad);
+	p += strlen(p);
+	p = progress_int(p, "low_bad", s.low_bad);
+	p = progress_int(p, "best_num_bad", s.best_num_bad);
+	sprintf(p, ",\"age\":%.3f}", now - s.when);
+	p += strlen(p);
+    }
+    sprintf(p, "],\"flips\":%.0f,\"flips_per_second\":%.1f", flips, rate);
+    p += strlen(p);
+    p = progress_int(p, "best_num_bad", best);
+    sprintf(p, "}\n");
+    return (int) (p - buf) + 2;
+}
+
+static void
+progress_signal(PROTO(int) sig)
+     /* SIGUSR1: ask for a snapshot at the next flip or try */
+PARAMS( int sig; )
+{
+    progress_requested = 1;
+    signals_pending = 1;
+}
+
+void
+progress_install()
+     /* Install the SIGUSR1 handler */
+{
+    progress_handle(SIGUSR1, progress_signal, SIGVTALRM);
+}
+
+void
+progress_service()
+     /* Write the snapshot SIGUSR1 asked for to stderr */
+{
+    sigset_t ticks, old;
+    int n;
+
+    if (!progress_requested) return;
+    progress_requested = 0;
+    sigemptyset(&ticks);
+    sigaddset(&ticks, SIGVTALRM);
+    sigprocmask(SIG_BLOCK, &ticks, &old);
+    if (progress_board == &progress_local){
+	progress_local.procs = 1;
+	if (progress_local.started == 0) progress_local.started = progress_clock();
+    }
+    progress_update();
+    n = progress_json(progress_buffer);
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    write(2, progress_buffer, (unsigned long) n);
+    progress_snapshots++;
+}
+
+static void
+progress_answer(PROTO(int) fd)
+     /* Read what there is of a request, and send the snapshot */
+PARAMS( int fd; )
+{
+    static char response[PROGRESS_BUFFER + MAXLINE];
+    char request[MAXLINE];
+    struct timeval tv;
+    fd_set fds;
+    int n;
+
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    tv.tv_sec = 0;
+    tv.tv_usec = PROGRESS_WAIT_USECS;
+    if (select(fd + 1, &fds, NULL, NULL, &tv) > 0)
+      read(fd, request, (unsigned long) sizeof(request));
+    n = progress_json(progress_buffer);
+    sprintf(response, "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\n"
+	    "Content-Length: %d\r\n\r\n", n);
+    strcat(response, progress_buffer);
+    write(fd, response, (unsigned long) strlen(response));
+    close(fd);
+}
+
+static void
+progress_serve(PROTO(int) listen_fd)
+     /* The server process: answer connections until gsat is gone */
+PARAMS( int listen_fd; )
+{
+    struct timeval tv;
+    fd_set fds;
+    int fd;
+
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGUSR1, SIG_IGN);
+    signal(SIGTERM, SIG_DFL);
+    progress_proc = -1;		/* every slot is another process's */
+    for (;;){
+	if (progress_board->stop || getppid() == 1) break;
+	FD_ZERO(&fds);
+	FD_SET(listen_fd, &fds);
+	tv.tv_sec = 1;
+	tv.tv_usec = 0;
+	if (select(listen_fd + 1, &fds, NULL, NULL, &tv) <= 0) continue;
+	if ((fd = accept(listen_fd, NULL, NULL)) >= 0)
+	  progress_answer(fd);
+    }
+    if (strchr(progress_address, '/') != NULL) cluster_unlink_socket(progress_address);
+    _exit(0);
+}
+
+void
+progress_start()
+     /* Make the board, start the updates and fork the server; called
+	once the wff is read, before the elite workers are forked */
+{
+    int listen_fd;
+
+    progress_board = (struct progress_board_str *)
+      mmap(NULL, sizeof(struct progress_board_str), PROT_READ | PROT_WRITE,
+	   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (progress_board == (struct progress_board_str *) MAP_FAILED)
+      crash_and_burn("ERROR: cannot map progress board\n");
+    memset((char *) progress_board, 0, sizeof(struct progress_board_str));
+    progress_board->procs = flag_elite ? elite_workers : 1;
+    progress_board->started = progress_clock();
+
+    if (progress_address[0]){
+	if ((listen_fd = cluster_socket(progress_address, CLUSTER_LISTEN_LOCAL, 8)) < 0){
+	    sprintf(ss, "ERROR: cannot listen for progress at %s\n", progress_address);
+	    crash_and_burn(ss);
+	}
+	fflush(stdout);
+	progress_server_pid = fork();
+	if (progress_server_pid < 0)
+	  crash_and_burn("ERROR: cannot fork progress server\n");
+	if (progress_server_pid == 0)
+	  progress_serve(listen_fd);
+	close(listen_fd);
+    }
+    progress_attach(0);
+}
+
+void
+progress_attach(PROTO(int) proc)
+     /* Take slot proc of the board and start updating it */
+PARAMS( int proc; )
+{
+    struct itimerval it;
+
+    progress_proc = proc;
+    progress_prev_flips = 0;
+    progress_prev_when = 0;
+    progress_update();
+    progress_handle(SIGVTALRM, progress_tick, SIGUSR1);
+    it.it_interval.tv_sec = PROGRESS_USECS / 1000000;
+    it.it_interval.tv_usec = PROGRESS_USECS % 1000000;
+    it.it_value = it.it_interval;
+    setitimer(ITIMER_VIRTUAL, &it, NULL);
+}
+
+void
+progress_finish()
+     /* Stop the updates and the server */
+{
+    struct itimerval it;
+
+    memset((char *) &it, 0, sizeof(it));
+    setitimer(ITIMER_VIRTUAL, &it, NULL);
+    signal(SIGVTALRM, SIG_IGN);
+    progress_update();
+    progress_board->stop = 1;
+    if (progress_server_pid > 0){
+	kill(progress_server_pid, SIGTERM);
+	waitpid(progress_server_pid, NULL, 0);
+	progress_server_pid = -1;
+	if (strchr(progress_address, '/') != NULL) cluster_unlink_socket(progress_address);
+    }
+}
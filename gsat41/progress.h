@@ -0,0 +1,26 @@
+/* progress.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int progress_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void progress_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void progress_install, ());
+EXTERN_FUNCTION( void progress_service, ());
+EXTERN_FUNCTION( void progress_start, ());
+EXTERN_FUNCTION( void progress_attach, (int proc));
+EXTERN_FUNCTION( void progress_finish, ());
+
+#endif
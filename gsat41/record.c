@@ -0,0 +1,169 @@
+/* record.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Flip recorder.  Tracing flips formats a line of text per flip, and
+   forces the generic flip loop.  Recording instead stores a fixed-size
+   record per flip (see record.h) straight into a file mapped into
+   memory, which is grown by RECORD_CHUNK records whenever it fills,
+   and works in the specialized flip loops too.  The header's count of
+   records is brought up to date after every try, so a run that is
+   killed leaves a file that can be read up to its last whole try.  The
+   flipstat program reads the file afterwards. */
+
+#include "gsat.h"
+#include "record.h"
+#include "utils.h"
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+EXTERN_FUNCTION( int ftruncate, (int fd, off_t length));
+EXTERN_FUNCTION( int close, (int fd));
+
+#define RECORD_CHUNK (1 << 20)	/* records added each time the file grows */
+
+char record_file[MAXLINE];
+int record_fd = -1;
+record_header_ptr record_header = NULL;
+record_ptr record_next = NULL, record_end = NULL;
+size_t record_capacity;		/* records the file has room for */
+int record_source;
+long record_count;		/* records complete, as in the header */
+
+
+int
+record_parse_parameters(PROTO(char *) inputline)
+     /* Parse "record FILE"; returns 1 */
+PARAMS( char * inputline; )
+{
+    if (sscanf(inputline, " record %s", record_file) != 1){
+	crash_maybe(" Error: record needs a file name\n");
+	return 0;
+    }
+    printf(" option: record flips to %s\n", record_file);
+    return 1;
+}
+
+void
+record_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "record_file: %s\n", record_file);
+    fprintf(fp_report, "records: %ld\n", record_count);
+}
+
+static size_t
+record_file_size(PROTO(size_t) records)
+PARAMS( size_t records; )
+{
+    return sizeof(struct record_header_str) + records * sizeof(struct record_str);
+}
+
+static void
+record_map(PROTO(size_t) capacity, PROTO(size_t) used)
+     /* Size the file for capacity records and map it */
+PARAMS( size_t capacity; size_t used; )
+{
+    char * base;
+
+    if (ftruncate(record_fd, (off_t) record_file_size(capacity)) != 0){
+	sprintf(ss, "ERROR: cannot grow record file %s\n", record_file);
+	crash_and_burn(ss);
+    }
+    base = (char *) mmap(NULL, record_file_size(capacity), PROT_READ | PROT_WRITE,
+			 MAP_SHARED, record_fd, (off_t) 0);
+    if (base == (char *) MAP_FAILED){
+	sprintf(ss, "ERROR: cannot map record file %s\n", record_file);
+	crash_and_burn(ss);
+    }
+    record_header = (record_header_ptr) base;
+    record_next = (record_ptr) (base + sizeof(struct record_header_str)) + used;
+    record_end = (record_ptr) (base + sizeof(struct record_header_str)) + capacity;
+    record_capacity = capacity;
+}
+
+static size_t
+record_used()
+{
+    return record_next - (record_ptr) (record_header + 1);
+}
+
+void
+record_start()
+     /* Create the file and fill in its header */
+{
+    if ((record_fd = open(record_file, O_RDWR | O_CREAT | O_TRUNC, 0666)) < 0){
+	sprintf(ss, "ERROR: cannot open record file %s\n", record_file);
+	crash_and_burn(ss);
+    }
+    record_map((size_t) RECORD_CHUNK, (size_t) 0);
+    memcpy(record_header->magic, RECORD_MAGIC, sizeof(record_header->magic));
+    record_header->version = RECORD_VERSION;
+    record_header->record_size = sizeof(struct record_str);
+    record_header->nvars = nvars;
+    record_header->nclauses = nclauses;
+    record_header->max_flips = max_flips;
+    record_header->max_tries = max_tries;
+    record_header->seed1 = seed1;
+    record_header->seed2 = seed2;
+    record_header->records = record_count = 0;
+}
+
+void
+record_grow()
+     /* The mapping is full: add another RECORD_CHUNK records */
+{
+    size_t used;
+
+    used = record_used();
+    munmap((char *) record_header, record_file_size(record_capacity));
+    record_map(record_capacity + RECORD_CHUNK, used);
+}
+
+void
+record_start_try()
+     /* Mark the start of a try; called once init_bad is known */
+{
+    if (record_next == record_end) record_grow();
+    record_next->flip = current_try;
+    record_next->var = 0;
+    record_next->diff = 0;
+    record_next->make = 0;
+    record_next->num_bad = init_bad;
+    record_next->source = RECORD_TRY;
+    record_next++;
+}
+
+void
+record_end_try()
+{
+    record_header->records = record_count = record_used();
+}
+
+void
+record_finish()
+     /* Cut the file to the records written and close it */
+{
+    size_t used;
+
+    used = record_used();
+    record_header->records = record_count = used;
+    munmap((char *) record_header, record_file_size(record_capacity));
+    if (ftruncate(record_fd, (off_t) record_file_size(used)) != 0){
+	sprintf(ss, "ERROR: cannot cut record file %s\n", record_file);
+	crash_and_burn(ss);
+    }
+    close(record_fd);
+    record_fd = -1;
+    printf("records: %ld in %s\n", record_count, record_file);
+}
@@ -0,0 +1,84 @@
+/* record.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef RECORD_H
+#define RECORD_H
+#include "proto.h"
+
+#define RECORD_MAGIC "GSATFLIP"
+#define RECORD_VERSION 1
+
+/* Pick sources; RECORD_TRY marks the start of a try */
+#define RECORD_GREEDY 0
+#define RECORD_WALK 1
+#define RECORD_ANNEAL 2
+#define RECORD_NOVELTY 3
+#define RECORD_CCANR 4
+#define RECORD_PROBSAT 5
+#define RECORD_PLATEAU 6
+#define RECORD_MANUAL 7
+#define RECORD_BIGFLIP 8
+#define RECORD_TRY 9
+#define RECORD_SOURCES 10
+
+#define RECORD_SOURCE_NAMES { "greedy", "walk", "anneal", "novelty", "ccanr", \
+			      "probsat", "plateau", "manual", "bigflip", "try" }
+
+typedef struct record_header_str {
+    char magic[8];		/* RECORD_MAGIC */
+    int version;		/* RECORD_VERSION */
+    int record_size;		/* sizeof(struct record_str) */
+    int nvars;
+    int nclauses;
+    int max_flips;
+    int max_tries;
+    int seed1;
+    int seed2;
+    long long records;		/* records complete, updated after each try */
+} *record_header_ptr;
+
+/* One flip, or with source RECORD_TRY the start of try number flip,
+   with num_bad the bad clauses of its initial assignment */
+typedef struct record_str {
+    int flip;			/* flip number within the try */
+    int var;			/* var flipped, negative if flipped to false */
+    int diff;			/* its diff and make before the flip */
+    int make;
+    int num_bad;		/* bad clauses after the flip */
+    int source;			/* RECORD_GREEDY ... */
+} *record_ptr;
+
+extern int record_source;	/* how the var being flipped was picked */
+extern record_ptr record_next, record_end;
+
+/* Append the flip of VAR, whose diff and make were DIFF and MAKE;
+   used once its value is flipped and the diffs updated */
+#define record_flip(VAR, DIFF, MAKE) { \
+    if (record_next == record_end) record_grow(); \
+    record_next->flip = flip; \
+    record_next->var = (assign[VAR].value > 0) ? (VAR) : -(VAR); \
+    record_next->diff = (DIFF); \
+    record_next->make = (MAKE); \
+    record_next->num_bad = current_num_bad; \
+    record_next->source = record_source; \
+    record_next++; }
+
+EXTERN_FUNCTION( int record_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void record_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void record_start, ());
+EXTERN_FUNCTION( void record_start_try, ());
+EXTERN_FUNCTION( void record_end_try, ());
+EXTERN_FUNCTION( void record_grow, ());
+EXTERN_FUNCTION( void record_finish, ());
+
+#endif
@@ -0,0 +1,248 @@
+/* reorder.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#include "gsat.h"
+#include "reorder.h"
+#include "utils.h"
+
+int * reorder_new_to_old = NULL;
+int * reorder_old_to_new = NULL;
+
+double reorder_span_before;	/* mean (highest - lowest var) of a clause, as read in */
+double reorder_span_after;	/* the same after renumbering */
+
+static char *reorder_names[] = { "none", "bfs", "cm", "rcm" };
+
+static int *reorder_degree;	/* used by compare_degree */
+
+
+int
+reorder_parse_parameters(PROTO(char *) inputline)
+     /* Parse "reorder [bfs|cm|rcm]"; return the method, default cm */
+PARAMS( char * inputline; )
+{
+    char word[MAXLINE];
+    int i;
+
+    if (sscanf(inputline, " reorder %s", word) != 1)
+      strcpy(word, "cm");
+    for (i = 0; i <= FLAG_REORDER_RCM; i++){
+	if (strcmp(word, reorder_names[i]) == 0){
+	    printf(" option: reorder = %s\n", word);
+	    return i;
+	}
+    }
+    sprintf(ss, " ERROR: unknown reorder method %s\n", word);
+    crash_maybe(ss);
+    return 0;
+}
+
+void
+reorder_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_reorder: %s\n", reorder_names[flag_reorder]);
+    fprintf(fp_report, "reorder_span_before: %.2f\n", reorder_span_before);
+    fprintf(fp_report, "reorder_span_after: %.2f\n", reorder_span_after);
+}
+
+static int
+compare_degree(PROTO(const void *) a, PROTO(const void *) b)
+     /* qsort order on variables: by increasing degree, then by name */
+PARAMS( char * a; char * b; )
+{
+    int u, v;
+
+    u = *(int *)a;
+    v = *(int *)b;
+    if (reorder_degree[u] != reorder_degree[v])
+      return reorder_degree[u] - reorder_degree[v];
+    return u - v;
+}
+
+double
+mean_clause_span()
+     /* Average over clauses of the distance between the highest and
+	lowest variable in the clause; a rough measure of how far apart
+	in assign[] the variables touched by one clause are */
+{
+    int i, j, clause_index, clause_len, v, lo, hi;
+    double total;
+
+    total = 0;
+    clause_index = 1;
+    for (i=1; i<=nclauses; i++) {
+	clause_len = wff[clause_index].lit;
+	lo = BIG;
+	hi = 0;
+	for (j=1; j<=clause_len; j++) {
+	    v = abs_val(wff[clause_index + j].lit);
+	    if (v < lo) lo = v;
+	    if (v > hi) hi = v;
+	}
+	if (clause_len > 0) total += hi - lo;
+	clause_index += clause_len + 1;
+    }
+    return (nclauses > 0) ? total / nclauses : 0.0;
+}
+
+void
+reorder_wff()
+     /* Renumber the variables in breadth first (optionally Cuthill-McKee)
+	order of the variable interaction graph, then sort the clauses by
+	their lowest new variable and the literals of each clause by
+	variable.  The variables and clauses visited when a variable is
+	flipped then lie close together in assign[] and wff[].  Must be
+	called after read_in() and before init_pointers(), which rebuilds
+	the occurrence chains from the new layout. */
+{
+    int *occ_start, *occ, *by_degree, *clause_key, *clause_pos, *count;
+    int *old_to_new, *new_to_old;
+    wff_str_ptr old_wff;
+    int i, j, k, n, head, first, clause_index, clause_len, v, u, lit, lit_var, wffindex;
+
+    if (flag_coloring || flag_graphics){
+	printf("Warning!  reorder ignored with color, xgsat and xqueens options\n");
+	flag_reorder = 0;
+	return;
+    }
+    reorder_span_before = mean_clause_span();
+
+    /* Occurrence lists: the clause indexes containing variable v are
+       occ[occ_start[v]] ... occ[occ_start[v+1]-1] */
+    occ_start = (int *) malloc((size_t)((nvars + 2) * sizeof(int)));
+    occ = (int *) malloc((size_t)((max_value(nlits, nclauses) + 1) * sizeof(int)));
+    reorder_degree = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    for (v=0; v<=nvars+1; v++) occ_start[v] = 0;
+    clause_index = 1;
+    for (i=1; i<=nclauses; i++) {
+	clause_len = wff[clause_index].lit;
+	for (j=1; j<=clause_len; j++)
+	  occ_start[abs_val(wff[clause_index + j].lit) + 1]++;
+	clause_index += clause_len + 1;
+    }
+    for (v=1; v<=nvars; v++) {
+	reorder_degree[v] = occ_start[v + 1];
+	occ_start[v + 1] += occ_start[v];
+    }
+    clause_index = 1;
+    for (i=1; i<=nclauses; i++) {
+	clause_len = wff[clause_index].lit;
+	for (j=1; j<=clause_len; j++)
+	  occ[occ_start[abs_val(wff[clause_index + j].lit)]++] = clause_index;
+	clause_index += clause_len + 1;
+    }
+    for (v=nvars; v>=1; v--) occ_start[v] = occ_start[v - 1];
+    occ_start[1] = 0;
+
+    /* Breadth first search, starting each component at its unvisited
+       variable of least degree.  new_to_old doubles as the queue. */
+    by_degree = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    old_to_new = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    new_to_old = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+    for (v=1; v<=nvars; v++) {
+	by_degree[v] = v;
+	old_to_new[v] = 0;
+    }
+    qsort((char *) &by_degree[1], nvars, sizeof(int), compare_degree);
+    n = 0;
+    head = 0;
+    for (k=1; k<=nvars; k++) {
+	if (old_to_new[by_degree[k]]) continue;
+	old_to_new[by_degree[k]] = ++n;
+	new_to_old[n] = by_degree[k];
+	while (head < n) {
+	    v = new_to_old[++head];
+	    first = n + 1;
+	    for (i=occ_start[v]; i<occ_start[v + 1]; i++) {
+		clause_index = occ[i];
+		clause_len = wff[clause_index].lit;
+		for (j=1; j<=clause_len; j++) {
+		    u = abs_val(wff[clause_index + j].lit);
+		    if (old_to_new[u] == 0) {
+			old_to_new[u] = ++n;
+			new_to_old[n] = u;
+		    }
+		}
+	    }
+	    if (flag_reorder != FLAG_REORDER_BFS && n >= first) {
+		qsort((char *) &new_to_old[first], n + 1 - first, sizeof(int), compare_degree);
+		for (i=first; i<=n; i++) old_to_new[new_to_old[i]] = i;
+	    }
+	}
+    }
+    if (flag_reorder == FLAG_REORDER_RCM) {
+	for (i=1, j=nvars; i<j; i++, j--) {
+	    v = new_to_old[i];
+	    new_to_old[i] = new_to_old[j];
+	    new_to_old[j] = v;
+	}
+	for (i=1; i<=nvars; i++) old_to_new[new_to_old[i]] = i;
+    }
+
+    /* Stable counting sort of the clauses by lowest new variable */
+    clause_key = (int *) malloc((size_t)((nclauses + 1) * sizeof(int)));
+    clause_pos = (int *) malloc((size_t)((nclauses + 1) * sizeof(int)));
+    count = (int *) malloc((size_t)((nvars + 2) * sizeof(int)));
+    for (v=0; v<=nvars+1; v++) count[v] = 0;
+    clause_index = 1;
+    for (i=1; i<=nclauses; i++) {
+	clause_len = wff[clause_index].lit;
+	clause_key[i] = 0;
+	for (j=1; j<=clause_len; j++) {
+	    v = old_to_new[abs_val(wff[clause_index + j].lit)];
+	    if (j==1 || v < clause_key[i]) clause_key[i] = v;
+	}
+	count[clause_key[i] + 1]++;
+	clause_pos[i] = clause_index;
+	clause_index += clause_len + 1;
+    }
+    for (v=1; v<=nvars+1; v++) count[v] += count[v - 1];
+
+    /* Rewrite wff[] in place from a copy of the old layout */
+    old_wff = (wff_str_ptr) malloc((size_t)((nlits + nclauses + 1) * sizeof(struct wff_str)));
+    memcpy((char *) old_wff, (char *) wff, (size_t)((nlits + nclauses + 1) * sizeof(struct wff_str)));
+    for (i=1; i<=nclauses; i++) occ[count[clause_key[i]]++] = clause_pos[i];
+    wffindex = 1;
+    for (i=0; i<nclauses; i++) {
+	clause_index = occ[i];
+	clause_len = old_wff[clause_index].lit;
+	wff[wffindex].lit = clause_len;
+	wff[wffindex].next = -1;
+	for (j=1; j<=clause_len; j++) {
+	    lit = old_wff[clause_index + j].lit;
+	    lit = (lit < 0) ? -old_to_new[-lit] : old_to_new[lit];
+	    /* insertion sort by variable */
+	    lit_var = abs(lit);
+	    for (k=j; k>1 && abs(wff[wffindex + k - 1].lit) > lit_var; k--)
+	      wff[wffindex + k].lit = wff[wffindex + k - 1].lit;
+	    wff[wffindex + k].lit = lit;
+	    wff[wffindex + j].next = -1;
+	}
+	wffindex += clause_len + 1;
+    }
+
+    free((char *) old_wff);
+    free((char *) count);
+    free((char *) clause_pos);
+    free((char *) clause_key);
+    free((char *) by_degree);
+    free((char *) reorder_degree);
+    free((char *) occ);
+    free((char *) occ_start);
+
+    reorder_old_to_new = old_to_new;
+    reorder_new_to_old = new_to_old;
+    reorder_span_after = mean_clause_span();
+    printf("reorder: mean clause span %.2f -> %.2f\n", reorder_span_before, reorder_span_after);
+}
@@ -0,0 +1,39 @@
+/* reorder.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef REORDER_H
+#define REORDER_H
+#include "proto.h"
+
+#define FLAG_REORDER_BFS 1	/* breadth first order of the variable graph */
+#define FLAG_REORDER_CM 2	/* Cuthill-McKee: BFS, neighbors by increasing degree */
+#define FLAG_REORDER_RCM 3	/* reverse Cuthill-McKee */
+
+extern
+int * reorder_new_to_old;	/* internal var number -> name in the input file; */
+				/* NULL when the wff has not been reordered */
+extern
+int * reorder_old_to_new;	/* name in the input file -> internal var number */
+
+/* Convert between the names used in the input file and the internal
+   variable numbers, which index assign[] and appear in wff[] */
+#define external_var(v) (reorder_new_to_old ? reorder_new_to_old[v] : (v))
+#define internal_var(v) (reorder_old_to_new ? reorder_old_to_new[v] : (v))
+#define external_lit(l) ((l) < 0 ? -external_var(-(l)) : external_var(l))
+#define internal_lit(l) ((l) < 0 ? -internal_var(-(l)) : internal_var(l))
+
+EXTERN_FUNCTION( int reorder_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void reorder_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void reorder_wff, ());
+
+#endif
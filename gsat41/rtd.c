@@ -0,0 +1,399 @@
+/* rtd.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Run-length distribution.  With "rtd R [P]" gsat reads the wff once
+   and then makes R independent runs, each an ordinary run of up to
+   max_tries tries of max_flips flips, with its own random seed drawn
+   from gsat's seed.  Each run is a process forked from the loaded
+   parent, so runs share nothing but the wff, and up to P of them (by
+   default the number of processors) run at once.  A run puts its
+   flips, tries and user seconds to the end of its last try into its
+   slot of a table in anonymous shared memory; a run that fails to
+   satisfy the wff is censored at its flips.  The runs also keep the
+   best assignment any of them found, under a spin lock, for the
+   assignment file.
+
+   The report gives a line per run, quantiles of flips and seconds
+   (censored when the quantile lies among the unsolved runs), the
+   empirical CDF, and two fits.  The exponential fit takes the rate
+   as solved runs over all flips, the maximum likelihood estimate
+   with censoring, and gives its mean and the largest gap between the
+   fitted and empirical CDFs; a small gap means restarts neither help
+   nor hurt.  The restart fit works out, for a cutoff t at each solved
+   run length, the expected flips to a solution when runs are cut off
+   at t and restarted,
+
+       E(t) = (sum over runs of min(flips, t)) / (runs solved by t)
+
+   and suggests the t with the least E(t) as max_flips.  The runs
+   should then be single tries (max_tries 1) with max_flips large. */
+
+#include "gsat.h"
+#include "rtd.h"
+#include "tempering.h"
+#include "utils.h"
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/sysinfo.h>
+#endif
+
+EXTERN_FUNCTION( int fork, (void));
+EXTERN_FUNCTION( void _exit, (int status));
+
+#ifdef __GNUC__
+#define rtd_lock(P) while (__sync_lock_test_and_set(P, 1)) ;
+#define rtd_unlock(P) __sync_lock_release(P)
+#else
+#define rtd_lock(P) while (*(P)) ; *(P) = 1;
+#define rtd_unlock(P) *(P) = 0
+#endif
+
+#define RTD_FAILED -1		/* solved: the run's process died */
+
+typedef struct rtd_run_str {
+    int pid;
+    int seed;
+    int solved;			/* 1, 0, or RTD_FAILED */
+    int tries;
+    int num_bad;		/* best_num_bad of the run */
+    int downwards, sideways, upwards, null;
+    double flips;		/* to the solution, or in all if unsolved */
+    double seconds;		/* user time */
+} *rtd_run_ptr;
+
+struct rtd_board_str {
+    volatile int lock;		/* guards the best assignment */
+    volatile int best_num_bad;
+    int best_run, best_try, best_flip;
+};
+
+int rtd_runs;			/* R */
+int rtd_parallel;		/* P */
+struct rtd_board_str *rtd_board;
+rtd_run_ptr rtd_table;
+char *rtd_best;			/* value_best of the best run, 1 per true var */
+int rtd_solved, rtd_failed;
+double *rtd_sorted_flips, *rtd_sorted_seconds;	/* of the solved runs */
+
+static double rtd_quantiles[] = { 0.1, 0.25, 0.5, 0.75, 0.9, 0.95 };
+
+
+int
+rtd_parse_parameters(PROTO(char *) inputline)
+     /* Parse "rtd R [P]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    rtd_runs = 0;
+    rtd_parallel = 0;
+    if (sscanf(inputline, " rtd %d %d", &rtd_runs, &rtd_parallel) < 1 || rtd_runs < 1){
+	crash_maybe(" Error: rtd needs a number of runs\n");
+	return 0;
+    }
+    if (rtd_parallel < 1){
+#ifdef __linux__
+	rtd_parallel = get_nprocs();
+#else
+	rtd_parallel = 1;
+#endif
+    }
+    if (rtd_parallel > rtd_runs) rtd_parallel = rtd_runs;
+    printf(" option: run-length distribution of %d runs, %d at a time\n",
+	   rtd_runs, rtd_parallel);
+    return 1;
+}
+
+static int
+rtd_compare(PROTO(const void *) a, PROTO(const void *) b)
+PARAMS( const void * a; const void * b; )
+{
+    double x, y;
+
+    x = *(double *) a;
+    y = *(double *) b;
+    return (x < y) ? -1 : (x > y);
+}
+
+static int
+rtd_clamp(PROTO(double) x)
+     /* The totals of the report are ints */
+PARAMS( double x; )
+{
+    return (x > (double) BIG) ? BIG : (int) x;
+}
+
+static void
+rtd_child(PROTO(int) r)
+     /* Make run r and exit */
+PARAMS( int r; )
+{
+    rtd_run_ptr run;
+    int i;
+
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTERM, SIG_DFL);
+    freopen("/dev/null", "w", stdout);
+    flag_trace = 0;
+    flag_stream = 0;
+    flag_record = 0;
+    flag_phases = 0;
+    flag_progress = 0;
+    flag_graphics = 0;
+    report_interval = BIG;
+    fclose(try_stat_filep);
+    if ((try_stat_filep = tmpfile()) == NULL)
+      _exit(1);
+
+    run = &rtd_table[r];
+    tempering_reseed(run->seed);
+    elapsed_seconds();
+    main_tries();
+
+    run->seconds = elapsed_seconds();
+    run->solved = (total_num_assigns > 0);
+    run->tries = total_sum_tries;
+    run->flips = total_sum_flips;
+    run->num_bad = best_num_bad;
+    run->downwards = total_downwards;
+    run->sideways = total_sideways;
+    run->upwards = total_upwards;
+    run->null = total_null;
+
+    rtd_lock(&rtd_board->lock);
+    if (best_num_bad < rtd_board->best_num_bad){
+	rtd_board->best_num_bad = best_num_bad;
+	rtd_board->best_run = r;
+	rtd_board->best_try = best_try;
+	rtd_board->best_flip = best_flip;
+	for (i = 1; i <= nvars; i++)
+	  rtd_best[i] = (assign[i].value_best > 0);
+    }
+    rtd_unlock(&rtd_board->lock);
+    _exit(0);
+}
+
+static void
+rtd_gather()
+     /* Sort the solved runs, and give the parent the totals and the
+	best assignment of all the runs */
+{
+    rtd_run_ptr run;
+    double flips, solved_flips, seconds;
+    int r, i;
+
+    rtd_sorted_flips = (double *) malloc((size_t) (rtd_runs + 1) * sizeof(double));
+    rtd_sorted_seconds = (double *) malloc((size_t) (rtd_runs + 1) * sizeof(double));
+    if (rtd_sorted_flips == NULL || rtd_sorted_seconds == NULL)
+      crash_and_burn("ERROR: cannot allocate rtd tables\n");
+    rtd_solved = rtd_failed = 0;
+    flips = solved_flips = seconds = 0;
+    for (r = 0, run = rtd_table; r < rtd_runs; r++, run++){
+	if (run->solved == RTD_FAILED){
+	    rtd_failed++;
+	    continue;
+	}
+	flips += run->flips;
+	seconds += run->seconds;
+	total_sum_tries += run->tries;
+	total_downwards += run->downwards;
+	total_sideways += run->sideways;
+	total_upwards += run->upwards;
+	total_null += run->null;
+	if (run->solved){
+	    rtd_sorted_flips[rtd_solved] = run->flips;
+	    rtd_sorted_seconds[rtd_solved] = run->seconds;
+	    rtd_solved++;
+	    solved_flips += run->flips;
+	}
+    }
+    qsort((char *) rtd_sorted_flips, (size_t) rtd_solved, sizeof(double), rtd_compare);
+    qsort((char *) rtd_sorted_seconds, (size_t) rtd_solved, sizeof(double), rtd_compare);
+
+    total_num_assigns = rtd_solved;
+    total_sum_flips = rtd_clamp(flips);
+    total_sum_successful_flips = rtd_clamp(solved_flips);
+    experiment_seconds = seconds;
+
+    if (rtd_board->best_num_bad < BIG){
+	best_num_bad = rtd_board->best_num_bad;
+	best_try = rtd_board->best_try;
+	best_flip = rtd_board->best_flip;
+	for (i = 1; i <= nvars; i++)
+	  assign[i].value_best = rtd_best[i] ? 1 : -1;
+    }
+}
+
+void
+rtd_run()
+     /* Make the runs, P at a time; called instead of the tries */
+{
+    rtd_run_ptr run;
+    int r, next, running, pid, status;
+    size_t size;
+
+    if (flag_elite || flag_tempering || flag_worker || flag_multiple_assigns == 1)
+      crash_and_burn("ERROR: rtd cannot be combined with elite, tempering, worker or m\n");
+
+    size = sizeof(struct rtd_board_str) + rtd_runs * sizeof(struct rtd_run_str) + nvars + 1;
+    rtd_board = (struct rtd_board_str *)
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (rtd_board == (struct rtd_board_str *) MAP_FAILED)
+      crash_and_burn("ERROR: cannot map rtd table\n");
+    rtd_table = (rtd_run_ptr) (rtd_board + 1);
+    rtd_best = (char *) (rtd_table + rtd_runs);
+    rtd_board->lock = 0;
+    rtd_board->best_num_bad = BIG;
+    rtd_board->best_run = -1;
+    for (r = 0; r < rtd_runs; r++){
+	rtd_table[r].solved = RTD_FAILED;
+	/* drawn by the parent, so that the runs can be repeated from the seed */
+	rtd_table[r].seed = random_1_to(INT_PROB_BASE);
+    }
+
+    next = running = 0;
+    while (next < rtd_runs || running > 0){
+	while (running < rtd_parallel && next < rtd_runs){
+	    fflush(stdout);
+	    pid = fork();
+	    if (pid < 0)
+	      crash_and_burn("ERROR: rtd cannot fork\n");
+	    if (pid == 0)
+	      rtd_child(next);
+	    rtd_table[next].pid = pid;
+	    next++;
+	    running++;
+	}
+	if ((pid = wait(&status)) < 0) break;
+	if (signals_pending) service_signals();
+	for (r = 0, run = rtd_table; r < next && run->pid != pid; r++, run++);
+	if (r == next) continue;
+	running--;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	  run->solved = RTD_FAILED;
+	if (run->solved == RTD_FAILED)
+	  printf("RUN %d: seed=%d, failed\n", r + 1, run->seed);
+	else
+	  printf("RUN %d: seed=%d, solved=%d, tries=%d, flips=%.0f, seconds=%f\n",
+		 r + 1, run->seed, run->solved, run->tries, run->flips, run->seconds);
+    }
+    rtd_gather();
+}
+
+static void
+rtd_print_quantiles(PROTO(FILE *) fp_report, PROTO(int) n)
+     /* Quantiles over the n runs that finished, unsolved ones last */
+PARAMS( FILE * fp_report; int n; )
+{
+    int q, k;
+
+    for (q = 0; q < (int) (sizeof(rtd_quantiles) / sizeof(double)); q++){
+	k = (int) ceil(rtd_quantiles[q] * n);
+	if (k < 1) k = 1;
+	fprintf(fp_report, "QUANTILE %.2f: ", rtd_quantiles[q]);
+	if (k > rtd_solved)
+	  fprintf(fp_report, "censored\n");
+	else
+	  fprintf(fp_report, "flips=%.0f, seconds=%f\n",
+		  rtd_sorted_flips[k - 1], rtd_sorted_seconds[k - 1]);
+    }
+}
+
+void
+rtd_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    rtd_run_ptr run;
+    double flips, rate, gap, f, cost, best_cost, best_cut, mean;
+    int r, k, n;
+
+    fprintf(fp_report, "RUN-LENGTH DISTRIBUTION\n");
+    fprintf(fp_report, "rtd_runs: %d\n", rtd_runs);
+    fprintf(fp_report, "rtd_parallel: %d\n", rtd_parallel);
+    if (rtd_sorted_flips == NULL){
+	fprintf(fp_report, "\n");
+	return;
+    }
+    n = rtd_runs - rtd_failed;
+    fprintf(fp_report, "rtd_solved: %d\n", rtd_solved);
+    fprintf(fp_report, "rtd_failed: %d\n", rtd_failed);
+    if (n > 0)
+      fprintf(fp_report, "rtd_success_rate: %f\n", (double) rtd_solved / n);
+
+    flips = 0;
+    for (r = 0, run = rtd_table; r < rtd_runs; r++, run++){
+	if (run->solved == RTD_FAILED)
+	  fprintf(fp_report, "RUN %d: seed=%d, failed\n", r + 1, run->seed);
+	else {
+	    fprintf(fp_report, "RUN %d: seed=%d, solved=%d, tries=%d, flips=%.0f, seconds=%f, num_bad=%d\n",
+		    r + 1, run->seed, run->solved, run->tries, run->flips, run->seconds,
+		    run->num_bad);
+	    flips += run->flips;
+	}
+    }
+    if (rtd_solved == 0){
+	fprintf(fp_report, "\n");
+	return;
+    }
+
+    rtd_print_quantiles(fp_report, n);
+    for (k = 1; k <= rtd_solved; k++)
+      fprintf(fp_report, "CDF %d: p=%f, flips=%.0f, seconds=%f\n", k, (double) k / n,
+	      rtd_sorted_flips[k - 1], rtd_sorted_seconds[k - 1]);
+
+    mean = 0;
+    for (k = 0; k < rtd_solved; k++) mean += rtd_sorted_flips[k];
+    fprintf(fp_report, "rtd_mean_flips_solved: %f\n", mean / rtd_solved);
+
+    /* Exponential fit, with the unsolved runs censored */
+    rate = rtd_solved / flips;
+    gap = 0;
+    for (k = 1; k <= rtd_solved; k++){
+	f = 1 - exp(-rate * rtd_sorted_flips[k - 1]);
+	if (fabs(f - (double) k / n) > gap) gap = fabs(f - (double) k / n);
+	if (fabs(f - (double) (k - 1) / n) > gap) gap = fabs(f - (double) (k - 1) / n);
+    }
+    fprintf(fp_report, "rtd_exponential_mean_flips: %f\n", 1 / rate);
+    fprintf(fp_report, "rtd_exponential_cdf_gap: %f\n", gap);
+
+    /* Restarts at each solved run length */
+    best_cut = 0;
+    best_cost = -1;
+    for (k = 1; k <= rtd_solved; k++){
+	if (k < rtd_solved && rtd_sorted_flips[k] == rtd_sorted_flips[k - 1]) continue;
+	cost = 0;
+	for (r = 0, run = rtd_table; r < rtd_runs; r++, run++)
+	  if (run->solved != RTD_FAILED)
+	    cost += (run->flips < rtd_sorted_flips[k - 1]) ? run->flips : rtd_sorted_flips[k - 1];
+	cost /= k;
+	if (best_cost < 0 || cost < best_cost){
+	    best_cost = cost;
+	    best_cut = rtd_sorted_flips[k - 1];
+	}
+    }
+    fprintf(fp_report, "rtd_suggested_max_flips: %.0f\n", best_cut);
+    fprintf(fp_report, "rtd_expected_flips_with_restarts: %f\n", best_cost);
+    fprintf(fp_report, "rtd_restart_gain: %f\n", (1 / rate) / best_cost);
+    if (best_cut >= rtd_sorted_flips[rtd_solved - 1])
+      fprintf(fp_report, "(restarts do not pay: the longest solved run is the best cutoff)\n");
+    fprintf(fp_report, "\n");
+}
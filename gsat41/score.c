@@ -0,0 +1,215 @@
+/* score.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#include "gsat.h"
+#include "score.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+#define SCORE_INITIAL_RANGE 16	/* initial buckets on each side of diff 0 */
+#define SCORE_INITIAL_SIZE 16	/* initial capacity of a bucket */
+
+score_bucket_ptr score_bucket = NULL;
+int score_low = 0;
+int score_high = -1;
+int score_top = -BIG;
+
+
+void
+score_grow(PROTO(int) diff)
+     /* Extend the range of buckets to include diff, at least doubling it */
+PARAMS( int diff; )
+{
+    score_bucket_ptr new_bucket;
+    int new_low, new_high, range, d;
+
+    if (score_bucket == NULL){
+	new_low = -SCORE_INITIAL_RANGE;
+	new_high = SCORE_INITIAL_RANGE;
+    }
+    else {
+	range = score_high - score_low + 1;
+	new_low = (diff < score_low) ? score_low - range : score_low;
+	new_high = (diff > score_high) ? score_high + range : score_high;
+    }
+    if (diff < new_low) new_low = diff - SCORE_INITIAL_RANGE;
+    if (diff > new_high) new_high = diff + SCORE_INITIAL_RANGE;
+
+    new_bucket = (score_bucket_ptr) malloc((size_t)((new_high - new_low + 1) *
+						    sizeof(struct score_bucket_str)));
+    if (new_bucket == NULL)
+      crash_and_burn("ERROR: cannot allocate score buckets\n");
+    for (d = new_low; d <= new_high; d++){
+	if (d >= score_low && d <= score_high)
+	  new_bucket[d - new_low] = score_bucket[d - score_low];
+	else {
+	    new_bucket[d - new_low].len = 0;
+	    new_bucket[d - new_low].size = 0;
+	    new_bucket[d - new_low].vars = NULL;
+	}
+    }
+    if (score_bucket != NULL) free((char *) score_bucket);
+    score_bucket = new_bucket;
+    score_low = new_low;
+    score_high = new_high;
+}
+
+void
+score_grow_bucket(PROTO(score_bucket_ptr) sb)
+     /* Double the capacity of a full bucket */
+PARAMS( score_bucket_ptr sb; )
+{
+    sb->size = sb->size ? 2 * sb->size : SCORE_INITIAL_SIZE;
+    if (sb->size > nvars) sb->size = nvars;
+    if (sb->vars == NULL)
+      sb->vars = (int *) malloc((size_t)((sb->size + 1) * sizeof(int)));
+    else
+      sb->vars = (int *) realloc((char *) sb->vars, (size_t)((sb->size + 1) * sizeof(int)));
+    if (sb->vars == NULL)
+      crash_and_burn("ERROR: cannot allocate score bucket\n");
+}
+
+void
+score_clear()
+     /* Empty every bucket; score_top becomes -BIG */
+{
+    int i;
+    var_str_ptr varptr;
+
+    if (score_bucket == NULL) score_grow(0);
+    for (i = 0; i <= score_high - score_low; i++)
+      score_bucket[i].len = 0;
+    for (i = 0, varptr = assign; i <= nvars; i++, varptr++)
+      varptr->score_pos = 0;
+    score_top = -BIG;
+}
+
+int
+score_max()
+     /* Lower score_top past drained buckets, and return it;
+	-BIG if every bucket is empty */
+{
+    while (score_top >= score_low &&
+	   score_bucket[score_top - score_low].len == 0)
+      score_top--;
+    if (score_top < score_low)
+      score_top = -BIG;
+    return score_top;
+}
+
+int
+score_random_member()
+     /* Random var of greatest diff, or 0 if there are no candidates */
+{
+    score_bucket_ptr sb;
+
+    if (score_max() == -BIG) return 0;
+    sb = &score_bucket[score_top - score_low];
+    return sb->vars[random_1_to(sb->len)];
+}
+
+int
+score_max_allowed()
+     /* Greatest diff of a var that is not tabu; -BIG if there is none.
+	At most tabu_list_length vars are tabu, so a longer bucket
+	needs no scan. */
+{
+    score_bucket_ptr sb;
+    int d, i;
+
+    for (d = score_max(); d >= score_low; d--){
+	sb = &score_bucket[d - score_low];
+	if (sb->len > tabu_list_length) return d;
+	for (i = 1; i <= sb->len; i++)
+	  if (!is_tabu(&assign[sb->vars[i]])) return d;
+    }
+    return -BIG;
+}
+
+int
+score_random_allowed()
+     /* Random var of greatest diff that is not tabu, or 0 if there are
+	no candidates */
+{
+    score_bucket_ptr sb;
+    int d, i, n, var;
+
+    if ((d = score_max_allowed()) == -BIG) return 0;
+    sb = &score_bucket[d - score_low];
+    for (i = 1; i <= TABU_PICK_TRIES; i++){
+	var = sb->vars[random_1_to(sb->len)];
+	if (!is_tabu(&assign[var])) return var;
+    }
+    n = 0;
+    for (i = 1; i <= sb->len; i++)
+      if (!is_tabu(&assign[sb->vars[i]])) n++;
+    n = random_1_to(n);
+    for (i = 1; ; i++)
+      if (!is_tabu(&assign[sb->vars[i]]) && --n == 0)
+	return sb->vars[i];
+}
+
+void
+score_print(PROTO(char *) prompt)
+     /* Print the bucket of greatest diff, checking the positions */
+PARAMS( char * prompt; )
+{
+    score_bucket_ptr sb;
+    int i;
+
+    fputs(prompt, stdout);
+    if (score_max() == -BIG){
+	printf("(length 0)\n");
+	return;
+    }
+    sb = &score_bucket[score_top - score_low];
+    printf("(length %d) ", sb->len);
+    for (i=1; i<=sb->len; i++){
+	printf(" %d/%d ", sb->vars[i], assign[sb->vars[i]].diff);
+	if (assign[sb->vars[i]].score_pos != i){
+	    sprintf(ss, "Score bucket error - var %d pos = %d, not %d\n",
+		    sb->vars[i], assign[sb->vars[i]].score_pos, i);
+	    crash_and_burn(ss);
+	}
+    }
+    printf("\n");
+}
+
+void
+score_checkpoint()
+     /* The buckets, each in its order; the score and score_pos of each
+	var are saved with the var */
+{
+    score_bucket_ptr sb;
+    int low, high, d;
+
+    low = score_low;
+    high = score_high;
+    checkpoint_data((char *) &low, (long) sizeof(int));
+    checkpoint_data((char *) &high, (long) sizeof(int));
+    checkpoint_data((char *) &score_top, (long) sizeof(int));
+    if (checkpoint_loading()){
+	if (score_bucket == NULL) score_grow(0);
+	if (low < score_low) score_grow(low);
+	if (high > score_high) score_grow(high);
+	for (d = score_low; d <= score_high; d++)
+	  score_bucket[d - score_low].len = 0;
+    }
+    for (d = low; d <= high; d++){
+	sb = &score_bucket[d - score_low];
+	checkpoint_data((char *) &sb->len, (long) sizeof(int));
+	if (sb->len == 0) continue;
+	while (sb->size < sb->len) score_grow_bucket(sb);
+	checkpoint_data((char *) &sb->vars[1], (long) (sb->len * sizeof(int)));
+    }
+}
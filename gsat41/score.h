@@ -0,0 +1,75 @@
+/* score.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Score buckets for greedy (non-hillclimb) search.  Every candidate
+   variable is kept in the bucket of its diff value; a bucket is an
+   array with the same add/swap-delete discipline as the indexed
+   lists in gsat.h, so moving a variable between scores is O(1) and a
+   random member of the best bucket is picked in O(1).
+   score_top is raised on insertion and lowered lazily by score_max()
+   past buckets that have drained.  Tabu vars stay in their buckets;
+   score_max_allowed() and score_random_allowed() skip them. */
+
+#ifndef SCORE_H
+#define SCORE_H
+#include "proto.h"
+
+typedef struct score_bucket_str {
+    int len;			/* number of vars in the bucket */
+    int size;			/* allocated length of vars, not counting vars[0] */
+    int *vars;			/* vars[1..len] */
+} *score_bucket_ptr;
+
+extern
+score_bucket_ptr score_bucket;	/* score_bucket[d - score_low] holds vars with diff d */
+extern
+int
+  score_low,			/* lowest and highest diff with a bucket */
+  score_high,
+  score_top;			/* no bucket above score_top is occupied */
+
+#define score_is_in(VARPTR) \
+  (VARPTR->score_pos)
+
+#define score_insert(VARPTR) \
+{ score_bucket_ptr sb; \
+  if (VARPTR->diff < score_low || VARPTR->diff > score_high) score_grow(VARPTR->diff); \
+  sb = &score_bucket[VARPTR->diff - score_low]; \
+  if (sb->len == sb->size) score_grow_bucket(sb); \
+  sb->vars[VARPTR->score_pos = ++(sb->len)] = VARPTR->name; \
+  if ((VARPTR->score = VARPTR->diff) > score_top) score_top = VARPTR->diff; }
+
+#define score_delete(VARPTR) \
+{ score_bucket_ptr sb; \
+  sb = &score_bucket[VARPTR->score - score_low]; \
+  assign[sb->vars[VARPTR->score_pos] = sb->vars[(sb->len)--]].score_pos = VARPTR->score_pos; \
+  VARPTR->score_pos = 0; }
+
+#define score_delete_if_in(VARPTR) \
+{ if (score_is_in(VARPTR)) score_delete(VARPTR); }
+
+#define score_adjust(VARPTR) \
+{ if (! score_is_in(VARPTR)) { score_insert(VARPTR); } \
+  else if (VARPTR->score != VARPTR->diff) { score_delete(VARPTR); score_insert(VARPTR); } }
+
+EXTERN_FUNCTION( void score_grow, (int diff));
+EXTERN_FUNCTION( void score_grow_bucket, (score_bucket_ptr sb));
+EXTERN_FUNCTION( void score_clear, ());
+EXTERN_FUNCTION( int score_max, ());
+EXTERN_FUNCTION( int score_random_member, ());
+EXTERN_FUNCTION( int score_max_allowed, ());
+EXTERN_FUNCTION( int score_random_allowed, ());
+EXTERN_FUNCTION( void score_print, (char * prompt));
+EXTERN_FUNCTION( void score_checkpoint, ());
+
+#endif
@@ -0,0 +1,261 @@
+/* stream.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Stats stream.  The report file is rewritten in full at every
+   report, with the try statistics of all the tries so far copied into
+   it, so over a long run the reports cost time quadratic in the
+   tries.  The stream is written once, in order: a start record, one
+   record per try, one per intermediate report, and a summary record
+   at the end.  Nothing is rewritten, and the stream is flushed at each
+   report so that it can be followed while gsat runs.
+
+   In json format each record is one line holding a JSON object whose
+   "record" member is "start", "try", "report" or "summary".  In binary
+   format the file starts with the 8 bytes "GSATSTRM", the version 1
+   and the int 0x01020304 (to give the byte order), and each record is
+   an int type (1 to 4, in the order above), an int count N, and N
+   64-bit ints, the values of the fields of the json record in the
+   same order, without the strings.  Times are in microseconds. */
+
+#include "gsat.h"
+#include "stream.h"
+#include "utils.h"
+
+#define STREAM_JSON 0
+#define STREAM_BINARY 1
+
+#define STREAM_START 1
+#define STREAM_TRY 2
+#define STREAM_REPORT 3
+#define STREAM_SUMMARY 4
+
+#define STREAM_MAX_FIELDS 16
+
+typedef long long stream_int64;
+
+char stream_file[MAXLINE];
+int stream_format;
+FILE * stream_fp = NULL;
+int stream_records;		/* records written */
+
+static char * stream_record_names[] = { "", "start", "try", "report", "summary" };
+
+static char * stream_start_keys[] = { "program", "wff_file" };
+static char * stream_report_keys[] = { "message" };
+static char * stream_start_names[] = {
+    "nvars", "nclauses", "nlits", "max_flips", "max_tries", "seed1", "seed2" };
+static char * stream_try_names[] = {
+    "try", "init_bad", "max_flips", "max_diff", "num_bad", "low_bad",
+    "downwards", "sideways", "upwards", "null", "total_sum_flips" };
+static char * stream_report_names[] = {
+    "try", "total_num_assigns", "total_sum_tries", "total_sum_flips",
+    "total_downwards", "total_upwards", "total_sideways", "total_null",
+    "experiment_usecs", "best_num_bad", "best_try", "best_flip" };
+
+
+int
+stream_parse_parameters(PROTO(char *) inputline)
+     /* Parse "stream FILE [json|binary]"; returns 1 */
+PARAMS( char * inputline; )
+{
+    char word[MAXLINE];
+
+    word[0] = 0;
+    if (sscanf(inputline, " stream %s %s", stream_file, word) < 1){
+	crash_maybe(" Error: stream needs a file name\n");
+	return 0;
+    }
+    if (word[0] == 0 || strcmp(word, "json") == 0)
+      stream_format = STREAM_JSON;
+    else if (strcmp(word, "binary") == 0)
+      stream_format = STREAM_BINARY;
+    else {
+	sprintf(ss, " Error: unknown stream format %s\n", word);
+	crash_maybe(ss);
+	return 0;
+    }
+    printf(" option: stream %s records to %s\n",
+	   stream_format == STREAM_JSON ? "json" : "binary", stream_file);
+    return 1;
+}
+
+void
+stream_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "stream_file: %s\n", stream_file);
+    fprintf(fp_report, "stream_format: %s\n",
+	    stream_format == STREAM_JSON ? "json" : "binary");
+    fprintf(fp_report, "stream_records: %d\n", stream_records);
+}
+
+static void
+stream_json_string(PROTO(char *) s)
+     /* Write s as a JSON string, dropping a final newline */
+PARAMS( char * s; )
+{
+    putc('"', stream_fp);
+    for ( ; *s; s++){
+	if (*s == '"' || *s == '\\'){
+	    putc('\\', stream_fp);
+	    putc(*s, stream_fp);
+	}
+	else if (*s == '\n' && s[1] == 0)
+	  break;
+	else if ((unsigned char) *s < ' ')
+	  fprintf(stream_fp, "\\u%04x", (unsigned char) *s);
+	else
+	  putc(*s, stream_fp);
+    }
+    putc('"', stream_fp);
+}
+
+static void
+stream_record(PROTO(int) type, PROTO(char **) names, PROTO(long *) values, PROTO(int) n,
+	      PROTO(char **) keys, PROTO(char **) strings, PROTO(int) nstrings)
+     /* Write a record of n named values, and in json the nstrings
+	string members first */
+PARAMS( int type; char ** names; long * values; int n;
+	char ** keys; char ** strings; int nstrings; )
+{
+    int i;
+    int header[2];
+    stream_int64 v[STREAM_MAX_FIELDS];
+
+    if (stream_format == STREAM_BINARY){
+	header[0] = type;
+	header[1] = n;
+	for (i = 0; i < n; i++) v[i] = values[i];
+	if (fwrite((char *) header, sizeof(int), 2, stream_fp) != 2 ||
+	    fwrite((char *) v, sizeof(stream_int64), (size_t) n, stream_fp) != (size_t) n)
+	  crash_and_burn("ERROR: cannot write stream file\n");
+    }
+    else {
+	fprintf(stream_fp, "{\"record\":\"%s\"", stream_record_names[type]);
+	for (i = 0; i < nstrings; i++){
+	    fprintf(stream_fp, ",\"%s\":", keys[i]);
+	    stream_json_string(strings[i]);
+	}
+	for (i = 0; i < n; i++)
+	  fprintf(stream_fp, ",\"%s\":%ld", names[i], values[i]);
+	fprintf(stream_fp, "}\n");
+	if (ferror(stream_fp))
+	  crash_and_burn("ERROR: cannot write stream file\n");
+    }
+    stream_records++;
+}
+
+void
+stream_start()
+     /* Open the stream and write the start record; called once the
+	wff is read and the seeds are known */
+{
+    long values[STREAM_MAX_FIELDS];
+    int header[2];
+    char * strings[2];
+
+    if ((stream_fp = fopen(stream_file, "w")) == NULL){
+	sprintf(ss, "ERROR: cannot open stream file %s\n", stream_file);
+	crash_and_burn(ss);
+    }
+    stream_records = 0;
+    if (stream_format == STREAM_BINARY){
+	header[0] = 1;
+	header[1] = 0x01020304;
+	fwrite("GSATSTRM", 1, 8, stream_fp);
+	fwrite((char *) header, sizeof(int), 2, stream_fp);
+    }
+
+    values[0] = nvars;
+    values[1] = nclauses;
+    values[2] = nlits;
+    values[3] = max_flips;
+    values[4] = max_tries;
+    values[5] = seed1;
+    values[6] = seed2;
+    strings[0] = program_name;
+    if (strncmp(strings[0], "program: ", 9) == 0) strings[0] += 9;
+    strings[1] = wff_file;
+    stream_record(STREAM_START, stream_start_names, values, 7,
+		  stream_start_keys, strings, 2);
+    fflush(stream_fp);
+}
+
+void
+stream_try()
+     /* Write the record of the try just ended */
+{
+    long values[STREAM_MAX_FIELDS];
+
+    values[0] = current_try;
+    values[1] = init_bad;
+    values[2] = max_flips;
+    values[3] = current_max_diff;
+    values[4] = current_num_bad;
+    values[5] = low_bad;
+    values[6] = downwards_count;
+    values[7] = sideways_count;
+    values[8] = upwards_count;
+    values[9] = null_count;
+    values[10] = total_sum_flips;
+    stream_record(STREAM_TRY, stream_try_names, values, 11, NULL, NULL, 0);
+}
+
+static void
+stream_totals(PROTO(int) type, PROTO(char *) message)
+PARAMS( int type; char * message; )
+{
+    long values[STREAM_MAX_FIELDS];
+
+    values[0] = current_try;
+    values[1] = total_num_assigns;
+    values[2] = total_sum_tries;
+    values[3] = total_sum_flips;
+    values[4] = total_downwards;
+    values[5] = total_upwards;
+    values[6] = total_sideways;
+    values[7] = total_null;
+    values[8] = (long) (experiment_seconds * 1e6);
+    values[9] = best_num_bad;
+    values[10] = best_try;
+    values[11] = best_flip;
+    stream_record(type, stream_report_names, values, 12,
+		  stream_report_keys, &message, message != NULL);
+    fflush(stream_fp);
+}
+
+void
+stream_report(PROTO(char *) message)
+     /* Write an intermediate report record; experiment_seconds must be
+	up to date */
+PARAMS( char * message; )
+{
+    stream_totals(STREAM_REPORT, message);
+}
+
+void
+stream_finish(PROTO(char *) message)
+     /* Write the summary record and close the stream */
+PARAMS( char * message; )
+{
+    stream_totals(STREAM_SUMMARY, message);
+    fclose(stream_fp);
+    stream_fp = NULL;
+}
+
+void
+stream_flush()
+     /* Empty the buffer, e.g. before a fork */
+{
+    if (stream_fp != NULL) fflush(stream_fp);
+}
@@ -0,0 +1,26 @@
+/* stream.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef STREAM_H
+#define STREAM_H
+#include "proto.h"
+
+EXTERN_FUNCTION( int stream_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void stream_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void stream_start, ());
+EXTERN_FUNCTION( void stream_try, ());
+EXTERN_FUNCTION( void stream_report, (char * message));
+EXTERN_FUNCTION( void stream_finish, (char * message));
+EXTERN_FUNCTION( void stream_flush, ());
+
+#endif
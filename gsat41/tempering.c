@@ -0,0 +1,393 @@
+/* tempering.c -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+/* Parallel tempering (replica exchange) for the anneal search.
+
+   The ladder of temperatures is read with the annealing schedule
+   parser: each line "STEPS TEMP" of the file is one replica, and the
+   STEPS are ignored.  At the start of each try, after the initial
+   assignment is made, gsat forks one process per replica beyond the
+   first; the parent runs replica 0 and coordinates.  Each process
+   anneals at a fixed temperature with its own random seed.  Every
+   tempering_period flips all replicas meet: each sends its num_bad
+   to the parent over a pipe and blocks until the parent answers with
+   its new temperature.  Neighboring pairs of the ladder (alternately
+   the even and the odd pairs) exchange temperatures with probability
+   min(1, exp((B_i - B_j) * (E_i - E_j))), where B = 100 / TEMP and E
+   is num_bad.  Exchanging temperatures is equivalent to exchanging
+   configurations and moves no assignment.
+
+   The try ends in every replica as soon as one satisfies the wff or
+   max_flips is reached.  The replica with the fewest bad clauses then
+   sends its assignment to the parent, which rebuilds its diffs from
+   it, and the children exit.  Processes are used rather than threads
+   because the search state is global; fork gives each replica a copy
+   of it and shares the wff copy-on-write. */
+
+#include "gsat.h"
+#include "score.h"
+#include "anneal.h"
+#include "tempering.h"
+#include "checkpoint.h"
+#include "utils.h"
+#include <sys/types.h>
+#include <sys/wait.h>
+
+EXTERN_FUNCTION( int fork, (void));
+EXTERN_FUNCTION( int pipe, (int * fds));
+EXTERN_FUNCTION( int close, (int fd));
+EXTERN_FUNCTION( long read, (int fd, void * buf, unsigned long n));
+EXTERN_FUNCTION( long write, (int fd, const void * buf, unsigned long n));
+EXTERN_FUNCTION( void _exit, (int status));
+
+#define TEMPERING_MAX_REPLICAS 64
+#define TEMPERING_EXCHANGE 1	/* message: at an exchange point */
+#define TEMPERING_DONE 2	/* message: try has ended */
+#define TEMPERING_STOP (-1.0)	/* answer: end the try */
+
+struct tempering_msg_str {
+    int kind;
+    int num_bad;
+};
+
+int tempering_period;		/* flips between exchanges */
+int tempering_replicas;		/* number of replicas = lines in the ladder */
+int tempering_replica;		/* this process's replica; 0 = parent */
+int tempering_round;		/* exchanges so far in this try */
+int tempering_swaps_tried;
+int tempering_swaps_accepted;
+int tempering_child_wins;	/* tries whose final assignment came from a child */
+
+int tempering_pid[TEMPERING_MAX_REPLICAS];
+int tempering_to_child[TEMPERING_MAX_REPLICAS];	/* parent writes, child reads */
+int tempering_to_parent[TEMPERING_MAX_REPLICAS];	/* child writes, parent reads */
+int tempering_ladder[TEMPERING_MAX_REPLICAS];	/* replica at each rung */
+int tempering_rung[TEMPERING_MAX_REPLICAS];	/* rung of each replica */
+int tempering_bad[TEMPERING_MAX_REPLICAS];	/* num_bad at the last message */
+int tempering_done[TEMPERING_MAX_REPLICAS];	/* 1 = replica has ended its try */
+int tempering_stopping;		/* 1 = try is ending in every replica */
+
+
+int
+tempering_parse_parameters(PROTO(char *) inputline)
+     /* Parse "tempering FILE [K]" and read the ladder from FILE; returns
+	1, or 0 if the ladder cannot be used */
+PARAMS( char * inputline; )
+{
+    char line[MAXLINE + 8];	/* "anneal " and the file */
+    char file[MAXLINE];
+    int i;
+
+    tempering_period = 0;
+    if (sscanf(inputline, " tempering %s %d", file, &tempering_period) < 1){
+	crash_maybe(" Error: tempering needs a ladder file\n");
+	return 0;
+    }
+
+    /* flag_tempering keeps anneal_parse_parameters from resetting max_flips */
+    flag_tempering = 1;
+    sprintf(line, "anneal %s", file);
+    flag_anneal = anneal_parse_parameters(line);
+    flag_tempering = 0;
+    if (!flag_anneal) return 0;
+
+    tempering_replicas = anneal_ladder_size();
+    if (tempering_replicas < 2 || tempering_replicas > TEMPERING_MAX_REPLICAS){
+	sprintf(ss, " Error: tempering needs 2 to %d ladder lines, not %d\n",
+		TEMPERING_MAX_REPLICAS, tempering_replicas);
+	crash_maybe(ss);
+	flag_anneal = 0;
+	return 0;
+    }
+    for (i = 0; i < tempering_replicas; i++){
+	if (anneal_ladder_temp(i) <= 0.0){
+	    crash_maybe(" Error: tempering ladder temperatures must be positive\n");
+	    flag_anneal = 0;
+	    return 0;
+	}
+    }
+    printf(" option: tempering, %d replicas, ", tempering_replicas);
+    if (tempering_period > 0)
+      printf("exchange every %d flips\n", tempering_period);
+    else
+      printf("exchange every nvars flips\n");
+    tempering_swaps_tried = 0;
+    tempering_swaps_accepted = 0;
+    tempering_child_wins = 0;
+    return 1;
+}
+
+void
+tempering_print_report(PROTO(FILE *) fp_report)
+PARAMS( FILE * fp_report; )
+{
+    fprintf(fp_report, "flag_tempering: %d\n", flag_tempering);
+    fprintf(fp_report, "tempering_replicas: %d\n", tempering_replicas);
+    fprintf(fp_report, "tempering_period: %d\n", tempering_period);
+    fprintf(fp_report, "tempering_swaps_tried: %d\n", tempering_swaps_tried);
+    fprintf(fp_report, "tempering_swaps_accepted: %d\n", tempering_swaps_accepted);
+    fprintf(fp_report, "tempering_child_wins: %d\n", tempering_child_wins);
+}
+
+static void
+tempering_read(PROTO(int) fd, PROTO(char *) buf, PROTO(int) n)
+     /* Read exactly n bytes from a pipe */
+PARAMS( int fd; char * buf; int n; )
+{
+    long got;
+
+    while (n > 0){
+	got = read(fd, buf, (unsigned long) n);
+	if (got <= 0){
+	    sprintf(ss, "ERROR: tempering replica %d lost its pipe\n", tempering_replica);
+	    if (tempering_replica) _exit(1);
+	    crash_and_burn(ss);
+	}
+	buf += got;
+	n -= got;
+    }
+}
+
+static void
+tempering_write(PROTO(int) fd, PROTO(char *) buf, PROTO(int) n)
+     /* Write exactly n bytes to a pipe */
+PARAMS( int fd; char * buf; int n; )
+{
+    long put;
+
+    while (n > 0){
+	put = write(fd, buf, (unsigned long) n);
+	if (put <= 0){
+	    sprintf(ss, "ERROR: tempering replica %d lost its pipe\n", tempering_replica);
+	    if (tempering_replica) _exit(1);
+	    crash_and_burn(ss);
+	}
+	buf += put;
+	n -= put;
+    }
+}
+
+void
+tempering_reseed(PROTO(int) seed)
+     /* Give a replica (or any forked process) its own random sequence */
+PARAMS( int seed; )
+{
+    if (rand_method == 1){
+#ifdef SYSVR4
+	srand48(seed);
+#else
+	srandom(seed);
+#endif
+    }
+    else
+      useed(rd, seed, seed2);
+}
+
+void
+tempering_start_try()
+     /* Fork the replicas; called at the end of main_init_try */
+{
+    int r, i, pid, seed;
+    int down[2], up[2];
+
+    if (tempering_period <= 0) tempering_period = nvars;
+    tempering_round = 0;
+    tempering_stopping = 0;
+    for (r = 0; r < tempering_replicas; r++){
+	tempering_ladder[r] = r;
+	tempering_rung[r] = r;
+	tempering_done[r] = 0;
+    }
+
+    fflush(stdout);
+    tempering_replica = 0;
+    for (r = 1; r < tempering_replicas; r++){
+	if (pipe(down) != 0 || pipe(up) != 0)
+	  crash_and_burn("ERROR: tempering cannot create pipes\n");
+	/* drawn by the parent, so that runs can be repeated from the seed */
+	seed = random_1_to(INT_PROB_BASE);
+	pid = fork();
+	if (pid < 0)
+	  crash_and_burn("ERROR: tempering cannot fork\n");
+	if (pid == 0){
+	    /* child: keep only its own ends */
+	    close(down[1]);
+	    close(up[0]);
+	    for (i = 1; i < r; i++){
+		close(tempering_to_child[i]);
+		close(tempering_to_parent[i]);
+	    }
+	    tempering_to_child[r] = down[0];
+	    tempering_to_parent[r] = up[1];
+	    tempering_replica = r;
+	    flag_trace = 0;
+	    flag_record = 0;	/* the file is shared; replica 0 records */
+	    flag_phases = 0;
+	    tempering_reseed(seed);
+	    anneal_set_temp(anneal_ladder_temp(r));
+	    return;
+	}
+	close(down[0]);
+	close(up[1]);
+	tempering_pid[r] = pid;
+	tempering_to_child[r] = down[1];
+	tempering_to_parent[r] = up[0];
+    }
+    anneal_set_temp(anneal_ladder_temp(0));
+}
+
+static void
+tempering_swap_rungs()
+     /* Decide the exchanges of this round from tempering_bad */
+{
+    int k, a, b;
+    double beta_a, beta_b, prob;
+
+    for (k = tempering_round % 2; k + 1 < tempering_replicas; k += 2){
+	a = tempering_ladder[k];
+	b = tempering_ladder[k + 1];
+	beta_a = 100.0 / anneal_ladder_temp(k);
+	beta_b = 100.0 / anneal_ladder_temp(k + 1);
+	prob = exp((beta_a - beta_b) * (tempering_bad[a] - tempering_bad[b]));
+	tempering_swaps_tried++;
+	if (prob >= 1.0 || random_01_prob(prob)){
+	    tempering_swaps_accepted++;
+	    tempering_ladder[k] = b;
+	    tempering_ladder[k + 1] = a;
+	    tempering_rung[b] = k;
+	    tempering_rung[a] = k + 1;
+	}
+    }
+    tempering_round++;
+}
+
+int
+tempering_exchange()
+     /* Called by every replica each tempering_period flips.  Returns 1
+	to go on at a possibly new temperature, 0 to end the try. */
+{
+    struct tempering_msg_str msg;
+    double temp;
+    int r;
+
+    if (tempering_replica){
+	msg.kind = TEMPERING_EXCHANGE;
+	msg.num_bad = current_num_bad;
+	tempering_write(tempering_to_parent[tempering_replica], (char *) &msg, sizeof(msg));
+	tempering_read(tempering_to_child[tempering_replica], (char *) &temp, sizeof(temp));
+	if (temp < 0) return 0;
+	anneal_set_temp(temp);
+	return 1;
+    }
+
+    if (tempering_stopping) return 0;
+    tempering_bad[0] = current_num_bad;
+    for (r = 1; r < tempering_replicas; r++){
+	tempering_read(tempering_to_parent[r], (char *) &msg, sizeof(msg));
+	tempering_bad[r] = msg.num_bad;
+	if (msg.kind == TEMPERING_DONE){
+	    tempering_done[r] = 1;
+	    tempering_stopping = 1;
+	}
+    }
+
+    if (!tempering_stopping) tempering_swap_rungs();
+    for (r = 1; r < tempering_replicas; r++){
+	if (tempering_done[r]) continue;
+	temp = tempering_stopping ? TEMPERING_STOP : anneal_ladder_temp(tempering_rung[r]);
+	tempering_write(tempering_to_child[r], (char *) &temp, sizeof(temp));
+    }
+    if (tempering_stopping) return 0;
+    anneal_set_temp(anneal_ladder_temp(tempering_rung[0]));
+    return 1;
+}
+
+void
+tempering_end_try()
+     /* Called by every replica when its try ends.  Children report and
+	exit; the parent takes over the best replica's assignment. */
+{
+    struct tempering_msg_str msg;
+    double temp;
+    int r, best, send, *values, i;
+
+    if (tempering_replica){
+	msg.kind = TEMPERING_DONE;
+	msg.num_bad = current_num_bad;
+	tempering_write(tempering_to_parent[tempering_replica], (char *) &msg, sizeof(msg));
+	tempering_read(tempering_to_child[tempering_replica], (char *) &send, sizeof(send));
+	if (send){
+	    values = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+	    for (i = 1; i <= nvars; i++) values[i] = assign[i].value;
+	    tempering_write(tempering_to_parent[tempering_replica], (char *) &values[1],
+			    nvars * sizeof(int));
+	}
+	fflush(stdout);
+	_exit(0);
+    }
+
+    /* Stop the replicas still flipping, and collect every final num_bad */
+    tempering_bad[0] = current_num_bad;
+    temp = TEMPERING_STOP;
+    for (r = 1; r < tempering_replicas; r++){
+	while (!tempering_done[r]){
+	    tempering_read(tempering_to_parent[r], (char *) &msg, sizeof(msg));
+	    tempering_bad[r] = msg.num_bad;
+	    if (msg.kind == TEMPERING_DONE)
+	      tempering_done[r] = 1;
+	    else
+	      tempering_write(tempering_to_child[r], (char *) &temp, sizeof(temp));
+	}
+    }
+
+    best = 0;
+    for (r = 1; r < tempering_replicas; r++)
+      if (tempering_bad[r] < tempering_bad[best]) best = r;
+    for (r = 1; r < tempering_replicas; r++){
+	send = (r == best);
+	tempering_write(tempering_to_child[r], (char *) &send, sizeof(send));
+    }
+
+    if (best){
+	tempering_child_wins++;
+	values = (int *) malloc((size_t)((nvars + 1) * sizeof(int)));
+	tempering_read(tempering_to_parent[best], (char *) &values[1], nvars * sizeof(int));
+	clear_out_lists();
+	for (i = 1; i <= nvars; i++) assign[i].value = values[i];
+	free((char *) values);
+	init_diff();
+	init_tabu();
+	init_buckets();
+	current_num_bad = get_bad_clauses(0, 0);
+	if (current_num_bad < low_bad){
+	    low_bad = current_num_bad;
+	    if (current_num_bad <= flag_save_best_max)
+	      save_current_as_low();
+	}
+    }
+
+    for (r = 1; r < tempering_replicas; r++){
+	close(tempering_to_child[r]);
+	close(tempering_to_parent[r]);
+	waitpid(tempering_pid[r], NULL, 0);
+    }
+}
+
+void
+tempering_checkpoint()
+     /* Replicas last one try; only the counts carry on */
+{
+    checkpoint_data((char *) &tempering_swaps_tried, (long) sizeof(int));
+    checkpoint_data((char *) &tempering_swaps_accepted, (long) sizeof(int));
+    checkpoint_data((char *) &tempering_child_wins, (long) sizeof(int));
+}
@@ -0,0 +1,29 @@
+/* tempering.h -- GSAT */
+
+/* DISCLAIMER                                                     */
+/* AT&T disclaims all warranties with regard to this program,     */
+/* including all implied warranties of merchantability and        */
+/* fitness.  In no event shall AT&T be liable for any special,    */
+/* indirect or consequential damages or any damages whatsoever    */
+/* resulting from loss of use, data or profits, whether in an     */
+/* action of contract, negligence or other tortious action,       */
+/* arising out of or in connection with the use or performance of */
+/* this program.                                                  */
+/*                                                                */
+
+#ifndef TEMPERING_H
+#define TEMPERING_H
+#include "proto.h"
+
+extern
+int tempering_period;		/* flips between exchanges */
+
+EXTERN_FUNCTION( int tempering_parse_parameters, (char * inputline));
+EXTERN_FUNCTION( void tempering_print_report, (FILE * fp_report));
+EXTERN_FUNCTION( void tempering_start_try, ());
+EXTERN_FUNCTION( int tempering_exchange, ());
+EXTERN_FUNCTION( void tempering_end_try, ());
+EXTERN_FUNCTION( void tempering_reseed, (int seed));
+EXTERN_FUNCTION( void tempering_checkpoint, ());
+
+#endif